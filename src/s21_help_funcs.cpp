@@ -1,19 +1,127 @@
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
 #include "s21_matrix_oop.h"
+#include "s21_thread_pool.h"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::atomic<bool> numa_interleave{false};
+
+// bit i set for every NUMA node i with cpus; zero when there is only one such node
+unsigned long numa_node_mask() {
+    static const unsigned long mask = [] {
+        unsigned long bits = 0;
+        int nodes = 0;
+        std::vector<std::vector<int>> topology = S21ThreadPool::numa_topology();
+        for (std::size_t id = 0; id < topology.size() && id < sizeof(bits) * 8; id++) {
+            if (!topology[id].empty()) {
+                bits |= 1UL << id;
+                nodes++;
+            }
+        }
+        return nodes > 1 ? bits : 0UL;
+    }();
+    return mask;
+}
+
+// Large blocks are page aligned so they can be interleaved; the caller
+// first-touches them. *zeroed tells whether a
+// requested zero fill is already done (small or very large blocks from calloc).
+// Either way the block is released with free().
+double* allocate_storage(long count, bool zero_fill, bool* zeroed) {
+    std::size_t bytes = static_cast<std::size_t>(count) * sizeof(double);
+    bool large = bytes >= S21_NUMA_MIN_BYTES;
+    bool interleave = large && numa_node_mask() != 0 && numa_interleave.load(std::memory_order_relaxed);
+    double* data = nullptr;
+    *zeroed = zero_fill && (!large || (bytes >= S21_LAZY_ZERO_BYTES && !interleave));
+    if (*zeroed) {
+        data = static_cast<double*>(std::calloc(count, sizeof(double)));
+    } else if (!large) {
+        data = static_cast<double*>(std::malloc(bytes));
+    } else {
+        std::size_t page = 4096;
+#ifdef __linux__
+        page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+        bytes = (bytes + page - 1) / page * page;
+        data = static_cast<double*>(std::aligned_alloc(page, bytes));
+#ifdef __linux__
+        unsigned long mask = numa_node_mask();
+        if (data != nullptr && interleave) {
+            const int kInterleave = 3;  // MPOL_INTERLEAVE
+            // best effort: on failure the pages simply follow the first touch
+            syscall(SYS_mbind, data, bytes, kInterleave, &mask, sizeof(mask) * 8, 0);
+        }
+#endif
+    }
+    if (data == nullptr) throw std::bad_alloc();
+    return data;
+}
+
+}  // namespace
 
-ExceptionError::ExceptionError() {}
+ExceptionError::ExceptionError() : _message("S21Matrix: invalid operation") {}
+ExceptionError::ExceptionError(const std::string& message) : _message(message) {}
 ExceptionError::~ExceptionError() {}
+const char* ExceptionError::what() const noexcept { return _message.c_str(); }
 
-void S21Matrix::init_matrix() {
+void S21Matrix::index_error(int row, int col) const {
+    throw ExceptionError("S21Matrix: index (" + std::to_string(row) + ", " + std::to_string(col) +
+                         ") is out of range for a " + std::to_string(_rows) + "x" + std::to_string(_cols) +
+                         " matrix");
+}
+
+void S21Matrix::shape_error(const char* message, const S21Matrix* other) const {
+    std::string shapes = std::to_string(_rows) + "x" + std::to_string(_cols);
+    if (other != nullptr) {
+        shapes += " and " + std::to_string(other->_rows) + "x" + std::to_string(other->_cols);
+    }
+    throw ExceptionError(std::string("S21Matrix: ") + message + " (" + shapes + ")");
+}
+
+void S21Matrix::init_matrix(bool zero_fill) {
+    _fingerprint.store(0, std::memory_order_relaxed);
+    _refs = new std::atomic<int>(1);
     _matrix = new double*[_rows];
-    for (int i = 0; i < _rows; i++) {
-        _matrix[i] = new double[_cols];
-        for (int j = 0; j < _cols; j++) {
-            _matrix[i][j] = 0.0;
-        }
+    bool zeroed = false;
+    try {
+        _matrix[0] = allocate_storage(static_cast<long>(_rows) * _cols, zero_fill, &zeroed);
+    } catch (...) {
+        delete[] _matrix;
+        delete _refs;
+        _matrix = nullptr;
+        _refs = nullptr;
+        throw;
     }
+    for (int i = 1; i < _rows; i++) {
+        _matrix[i] = _matrix[i - 1] + _cols;
+    }
+    if (zero_fill && !zeroed) {
+        // spread the first touch over the pool so the pages do not all land on the
+        // caller's node; chunks are claimed dynamically, so which node gets which rows
+        // is not tied to the thread that later processes them
+        int grain = S21ThreadPool::grain(_cols);
+        S21ThreadPool::instance().parallel_for(0, _rows, grain, [this](int from, int to) {
+            std::fill(_matrix[from], _matrix[from] + static_cast<long>(to - from) * _cols, 0.0);
+        });
+    }
+}
+
+bool S21Matrix::set_numa_interleave(bool enable) {
+    numa_interleave.store(enable, std::memory_order_relaxed);
+    return enable && numa_node_mask() != 0;
 }
 
-bool S21Matrix::comp_doubles(double a, double b) {
+bool S21Matrix::comp_doubles(double a, double b) const {
     bool result = true;
     double error = fabs(a - b);
     if (error > E) result = false;
@@ -21,38 +129,154 @@ bool S21Matrix::comp_doubles(double a, double b) {
 }
 
 void S21Matrix::clean_matrix() {
-    if (_matrix != nullptr) {
-        for (int i = 0; i < _rows; i++) {
-            delete[] _matrix[i];
-        }
+    if (_matrix != nullptr && _refs->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        free(_matrix[0]);
         delete[] _matrix;
+        delete _refs;
     }
+    _matrix = nullptr;
+    _refs = nullptr;
 }
 
 void S21Matrix::copy_matrix(const S21Matrix& other) {
+    init_matrix(false);
+    S21ThreadPool::instance().parallel_for(0, _rows, S21ThreadPool::grain(_cols), [&](int from, int to) {
+        std::copy(other._matrix[from], other._matrix[from] + static_cast<long>(to - from) * _cols,
+                  _matrix[from]);
+    });
+}
+
+void S21Matrix::detach() {
+    _fingerprint.store(0, std::memory_order_relaxed);
+    if (_matrix != nullptr && _refs->load(std::memory_order_acquire) > 1) {
+        S21Matrix shared(*this);
+        clean_matrix();
+        copy_matrix(shared);
+    }
+}
+
+void S21Matrix::resize(int rows, int cols) {
+    if (rows <= 0 || cols <= 0) {
+        throw ExceptionError("S21Matrix: dimensions must be positive");
+    }
+    S21Matrix old(std::move(*this));
+    _rows = rows;
+    _cols = cols;
     init_matrix();
-    for (int i = 0; i < _rows; i++) {
-        for (int j = 0; j < _cols; j++) {
-            _matrix[i][j] = other._matrix[i][j];
+    for (int i = 0; i < _rows && i < old._rows; i++) {
+        for (int j = 0; j < _cols && j < old._cols; j++) {
+            _matrix[i][j] = old._matrix[i][j];
         }
     }
 }
 
-S21Matrix S21Matrix::s21_get_minor_matrix(const S21Matrix& mat, int index, int jndex) {
-    S21Matrix result(mat._rows - 1, mat._cols - 1);
+void S21Matrix::s21_get_minor_matrix(const S21Matrix& mat, int index, int jndex, S21Matrix& result) const {
     for (int i = 0, mi = 0; i < mat._rows; i++) {
         for (int j = 0, mj = 0; j < mat._cols; j++) {
             if (i != index && j != jndex) result._matrix[mi][mj++] = mat._matrix[i][j];
         }
         if (index != i) mi++;
     }
+}
+
+namespace {
+
+std::atomic<unsigned long> scratch_hits{0};
+std::atomic<unsigned long> scratch_misses{0};
+
+// released temporaries of the calling thread, keyed by (rows << 32) | cols
+std::unordered_map<std::uint64_t, std::vector<S21Matrix>>& scratch_pool() {
+    thread_local std::unordered_map<std::uint64_t, std::vector<S21Matrix>> pool;
+    return pool;
+}
+
+std::uint64_t scratch_key(int rows, int cols) {
+    return (static_cast<std::uint64_t>(rows) << 32) | static_cast<std::uint32_t>(cols);
+}
+
+}  // namespace
+
+S21Matrix S21Matrix::acquire_scratch(int rows, int cols) {
+    std::vector<S21Matrix>& cached = scratch_pool()[scratch_key(rows, cols)];
+    if (cached.empty()) {
+        scratch_misses.fetch_add(1, std::memory_order_relaxed);
+        return S21Matrix(rows, cols, S21Uninitialized{});
+    }
+    scratch_hits.fetch_add(1, std::memory_order_relaxed);
+    S21Matrix result(std::move(cached.back()));
+    cached.pop_back();
+    result._fingerprint.store(0, std::memory_order_relaxed);
     return result;
 }
 
-int S21Matrix::get_rows() { return _rows; }
+void S21Matrix::release_scratch(S21Matrix&& scratch) {
+    if (scratch._matrix == nullptr || scratch._refs->load(std::memory_order_acquire) != 1) return;
+    std::vector<S21Matrix>& cached = scratch_pool()[scratch_key(scratch._rows, scratch._cols)];
+    if (cached.size() < S21_SCRATCH_PER_SHAPE) {
+        cached.push_back(std::move(scratch));
+    }
+}
+
+S21ScratchStats S21Matrix::scratch_stats() {
+    S21ScratchStats stats;
+    stats.hits = scratch_hits.load(std::memory_order_relaxed);
+    stats.misses = scratch_misses.load(std::memory_order_relaxed);
+    stats.cached = 0;
+    for (const auto& shape : scratch_pool()) stats.cached += shape.second.size();
+    return stats;
+}
+
+void S21Matrix::mul_rows(const S21Matrix& a, const S21Matrix& b, int from, int to) {
+    for (int i = from; i < to; i++) {
+        double* out = _matrix[i];
+        for (int k = 0; k < a._cols; k++) {
+            double aik = a._matrix[i][k];
+            const double* row = b._matrix[k];
+            for (int j = 0; j < b._cols; j++) {
+                out[j] += aik * row[j];
+            }
+        }
+    }
+}
+
+// out = a * b into a preallocated buffer that is reused when its shape fits
+void S21Matrix::mul_into(const S21Matrix& a, const S21Matrix& b, S21Matrix& out) {
+    if (out._rows != a._rows || out._cols != b._cols || out._refs->load(std::memory_order_acquire) > 1) {
+        out = S21Matrix(a._rows, b._cols, S21Uninitialized{});
+    }
+    out._fingerprint.store(0, std::memory_order_relaxed);
+    int grain = S21ThreadPool::grain(a._cols * b._cols);
+    S21ThreadPool::instance().parallel_for(0, a._rows, grain, [&](int from, int to) {
+        std::fill(out._matrix[from], out._matrix[from] + static_cast<long>(to - from) * out._cols, 0.0);
+        out.mul_rows(a, b, from, to);
+    });
+}
+
+void S21Matrix::swap(S21Matrix& other) noexcept {
+    std::swap(_rows, other._rows);
+    std::swap(_cols, other._cols);
+    std::swap(_matrix, other._matrix);
+    std::swap(_refs, other._refs);
+    std::uint64_t hash = _fingerprint.load(std::memory_order_relaxed);
+    _fingerprint.store(other._fingerprint.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    other._fingerprint.store(hash, std::memory_order_relaxed);
+}
+
+void S21Matrix::complements_rows(S21Matrix& result, int from, int to) const {
+    S21Matrix temp = acquire_scratch(_rows - 1, _cols - 1);
+    for (int i = from; i < to; i++) {
+        for (int j = 0; j < _cols; j++) {
+            s21_get_minor_matrix(*this, i, j, temp);
+            result._matrix[i][j] = temp.determinant() * ::pow(-1, (i + 1) + (j + 1));
+        }
+    }
+    release_scratch(std::move(temp));
+}
+
+int S21Matrix::get_rows() const { return _rows; }
 
-int S21Matrix::get_cols() { return _cols; }
+int S21Matrix::get_cols() const { return _cols; }
 
-void S21Matrix::set_rows(int rows) { _rows = rows; }
+void S21Matrix::set_rows(int rows) { resize(rows, _cols); }
 
-void S21Matrix::set_cols(int cols) { _cols = cols; }
+void S21Matrix::set_cols(int cols) { resize(_rows, cols); }
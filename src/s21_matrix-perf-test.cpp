@@ -0,0 +1,406 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+#include "s21_thread_pool.h"
+
+// Randomized cross-checks of the parallel and blocked kernels against plain
+// reference loops, at sizes up to 1024 and on shapes that straddle the block and
+// chunk boundaries, plus wall-clock budgets per operation and size.
+// S21_PERF_SEED selects another random stream, S21_PERF_SCALE multiplies every budget.
+// The pool runs with S21_THREADS workers, 4 unless set, so the chunked paths are
+// split even on a single-core runner.
+
+namespace {
+
+unsigned perf_seed() {
+    const char* value = std::getenv("S21_PERF_SEED");
+    return value != nullptr ? static_cast<unsigned>(std::strtoul(value, nullptr, 10)) : 21u;
+}
+
+double budget_scale() {
+    const char* value = std::getenv("S21_PERF_SCALE");
+    double scale = value != nullptr ? std::strtod(value, nullptr) : 1.0;
+    return scale > 0.0 ? scale : 1.0;
+}
+
+S21Matrix random_matrix(std::mt19937& gen, int rows, int cols) {
+    std::uniform_real_distribution<double> value(-1.0, 1.0);
+    S21Matrix result(rows, cols, S21Uninitialized{});
+    double* data = result.data();
+    for (long i = 0; i < static_cast<long>(rows) * cols; i++) data[i] = value(gen);
+    return result;
+}
+
+// random matrix with a dominant diagonal, so it is well conditioned
+S21Matrix random_regular(std::mt19937& gen, int n) {
+    S21Matrix result = random_matrix(gen, n, n);
+    for (int i = 0; i < n; i++) result(i, i) += n;
+    return result;
+}
+
+S21Matrix random_symmetric(std::mt19937& gen, int n) {
+    S21Matrix half = random_matrix(gen, n, n);
+    return half + half.transpose();
+}
+
+// sizes around the 16-element comparison blocks, the pairwise-sum leaves and the
+// pool's row chunks, followed by random ones
+std::vector<std::pair<int, int>> shapes(std::mt19937& gen) {
+    std::vector<std::pair<int, int>> result = {{1, 1},   {1, 17},   {17, 1},   {15, 16}, {16, 17},
+                                               {63, 65}, {127, 129}, {255, 3}, {3, 255}, {1024, 1}};
+    std::uniform_int_distribution<int> size(2, 300);
+    for (int i = 0; i < 6; i++) result.emplace_back(size(gen), size(gen));
+    return result;
+}
+
+S21Matrix reference_mul(const S21Matrix& a, const S21Matrix& b) {
+    S21Matrix result(a.get_rows(), b.get_cols());
+    for (int i = 0; i < a.get_rows(); i++) {
+        for (int j = 0; j < b.get_cols(); j++) {
+            long double sum = 0.0L;
+            for (int k = 0; k < a.get_cols(); k++) sum += static_cast<long double>(a(i, k)) * b(k, j);
+            result(i, j) = static_cast<double>(sum);
+        }
+    }
+    return result;
+}
+
+// determinant by Gaussian elimination in long double
+double reference_determinant(const S21Matrix& a) {
+    int n = a.get_rows();
+    std::vector<std::vector<long double>> m(n, std::vector<long double>(n));
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) m[i][j] = a(i, j);
+    }
+    long double det = 1.0L;
+    for (int j = 0; j < n; j++) {
+        int best = j;
+        for (int i = j + 1; i < n; i++) {
+            if (fabsl(m[i][j]) > fabsl(m[best][j])) best = i;
+        }
+        if (best != j) {
+            std::swap(m[best], m[j]);
+            det = -det;
+        }
+        det *= m[j][j];
+        for (int i = j + 1; i < n; i++) {
+            long double factor = m[i][j] / m[j][j];
+            for (int c = j; c < n; c++) m[i][c] -= factor * m[j][c];
+        }
+    }
+    return static_cast<double>(det);
+}
+
+// largest |a - b| relative to the largest |b|
+double relative_error(const S21Matrix& a, const S21Matrix& b) {
+    S21Matrix diff = a - b;
+    return diff.max_abs() / fmax(b.max_abs(), 1e-300);
+}
+
+// normwise backward error of x as a solution of a x = b
+double backward_error(const S21Matrix& a, const S21Matrix& x, const S21Matrix& b) {
+    return (a * x - b).norm_inf() / (a.norm_inf() * x.norm_inf() + b.norm_inf());
+}
+
+S21Matrix identity(int n) {
+    S21Matrix result(n, n);
+    for (int i = 0; i < n; i++) result(i, i) = 1.0;
+    return result;
+}
+
+// best of three runs, in milliseconds
+template <typename Op>
+double best_ms(Op op) {
+    double best = 0.0;
+    for (int run = 0; run < 3; run++) {
+        auto start = std::chrono::steady_clock::now();
+        op();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (run == 0 || elapsed.count() < best) best = elapsed.count();
+    }
+    return best;
+}
+
+// keeps results observable so the timed work is not optimized away
+volatile double sink = 0.0;
+
+}  // namespace
+
+TEST(PerfPool, SeveralWorkers) {
+    ASSERT_GT(S21ThreadPool::instance().size(), 1);
+    std::vector<int> chunks;
+    std::mutex mutex;
+    S21ThreadPool::instance().parallel_for(0, 1000, 1, [&](int from, int) {
+        std::lock_guard<std::mutex> lock(mutex);
+        chunks.push_back(from);
+    });
+    ASSERT_EQ(S21ThreadPool::instance().size() + 1, static_cast<int>(chunks.size()));
+}
+
+TEST(PerfMul, MatchesReference) {
+    std::mt19937 gen(perf_seed());
+    std::uniform_int_distribution<int> inner(1, 130);
+    for (const auto& shape : shapes(gen)) {
+        SCOPED_TRACE(testing::Message() << shape.first << "x" << shape.second << " seed " << perf_seed());
+        int k = inner(gen);
+        S21Matrix a = random_matrix(gen, shape.first, k), b = random_matrix(gen, k, shape.second);
+        S21Matrix c = a * b;
+        ASSERT_LE(relative_error(c, reference_mul(a, b)), 1e-13 * k);
+        S21Matrix in_place(a);
+        in_place.mul_matrix(b);
+        ASSERT_TRUE(in_place == c);
+    }
+    S21Matrix square = random_matrix(gen, 65, 65);
+    S21Matrix aliased(square);
+    aliased *= aliased;
+    ASSERT_LE(relative_error(aliased, reference_mul(square, square)), 1e-12);
+    ASSERT_TRUE(square.pow(2) == aliased);
+}
+
+TEST(PerfMul, FreivaldsAtScale) {
+    std::mt19937 gen(perf_seed());
+    // (A B) x == A (B x) for a random x checks the product in O(n^2)
+    int dims[][3] = {{1024, 1024, 1024}, {1023, 1025, 1001}, {1, 1024, 1024}, {1024, 7, 1024}};
+    for (const auto& dim : dims) {
+        SCOPED_TRACE(testing::Message() << dim[0] << "x" << dim[1] << "x" << dim[2]);
+        S21Matrix a = random_matrix(gen, dim[0], dim[1]), b = random_matrix(gen, dim[1], dim[2]);
+        S21Matrix x = random_matrix(gen, dim[2], 1);
+        S21Matrix lhs = (a * b) * x, rhs = a * (b * x);
+        ASSERT_LE(relative_error(lhs, rhs), 1e-11);
+    }
+}
+
+TEST(PerfElementwise, MatchesReference) {
+    std::mt19937 gen(perf_seed());
+    for (const auto& shape : shapes(gen)) {
+        int rows = shape.first, cols = shape.second;
+        SCOPED_TRACE(testing::Message() << rows << "x" << cols << " seed " << perf_seed());
+        S21Matrix a = random_matrix(gen, rows, cols), b = random_matrix(gen, rows, cols);
+        S21Matrix sum = a + b, diff = a - b, scaled = a * 3.5, trans = a.transpose();
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                ASSERT_EQ(a(i, j) + b(i, j), sum(i, j));
+                ASSERT_EQ(a(i, j) - b(i, j), diff(i, j));
+                ASSERT_EQ(a(i, j) * 3.5, scaled(i, j));
+                ASSERT_EQ(a(i, j), trans(j, i));
+            }
+        }
+        S21Matrix copy(a);
+        ASSERT_EQ(a.fingerprint(), copy.fingerprint());
+        ASSERT_TRUE(copy.eq_matrix(a, S21Compare::kUlp, 0));
+        copy(rows - 1, cols - 1) += 1e-9;
+        ASSERT_NE(a.fingerprint(), copy.fingerprint());
+        ASSERT_TRUE(a.eq_matrix(copy, S21Compare::kAbsolute, 2e-9));
+        ASSERT_FALSE(a.eq_matrix(copy, S21Compare::kAbsolute, 5e-10));
+        ASSERT_FALSE(a.eq_matrix(copy, S21Compare::kUlp, 4));
+        ASSERT_TRUE(a.eq_matrix(copy, S21Compare::kNorm, 1e-6));
+    }
+}
+
+TEST(PerfReduce, MatchesReference) {
+    std::mt19937 gen(perf_seed());
+    std::vector<std::pair<int, int>> cases = shapes(gen);
+    cases.emplace_back(1024, 1024);
+    cases.emplace_back(1, 1024 * 1024);
+    for (const auto& shape : cases) {
+        int rows = shape.first, cols = shape.second;
+        SCOPED_TRACE(testing::Message() << rows << "x" << cols << " seed " << perf_seed());
+        S21Matrix a = random_matrix(gen, rows, cols), b = random_matrix(gen, rows, cols);
+        long double total = 0.0L, squares = 0.0L, dot = 0.0L;
+        double low = a(0, 0), high = a(0, 0);
+        std::vector<long double> row(rows, 0.0L), col(cols, 0.0L);
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                double v = a(i, j);
+                total += v;
+                squares += static_cast<long double>(v) * v;
+                dot += static_cast<long double>(v) * b(i, j);
+                low = fmin(low, v);
+                high = fmax(high, v);
+                row[i] += v;
+                col[j] += v;
+            }
+        }
+        double scale = sqrt(static_cast<double>(rows) * cols);
+        ASSERT_NEAR(static_cast<double>(total), a.sum(), 1e-13 * scale);
+        ASSERT_NEAR(sqrt(static_cast<double>(squares)), a.norm_frobenius(), 1e-13 * scale);
+        ASSERT_NEAR(static_cast<double>(dot), a.dot(b), 1e-13 * scale);
+        ASSERT_EQ(low, a.min());
+        ASSERT_EQ(high, a.max());
+        ASSERT_EQ(fmax(-low, high), a.max_abs());
+        S21Matrix row_sums = a.row_sums(), col_sums = a.col_sums();
+        for (int i = 0; i < rows; i++) ASSERT_NEAR(static_cast<double>(row[i]), row_sums(i, 0), 1e-12 * cols);
+        for (int j = 0; j < cols; j++) ASSERT_NEAR(static_cast<double>(col[j]), col_sums(0, j), 1e-12 * rows);
+        ASSERT_NEAR(a.transpose().norm_one(), a.norm_inf(), 1e-12 * cols);
+    }
+}
+
+TEST(PerfSolve, BackwardStable) {
+    std::mt19937 gen(perf_seed());
+    for (int n : {1, 2, 15, 16, 17, 63, 64, 65, 257, 512}) {
+        SCOPED_TRACE(testing::Message() << "n = " << n << " seed " << perf_seed());
+        S21Matrix a = random_regular(gen, n), b = random_matrix(gen, n, 3);
+        S21Matrix x = a.solve(b);
+        ASSERT_LT(backward_error(a, x, b), 1e-13);
+        S21RefineInfo info;
+        S21Matrix refined = a.solve_refined(b, &info);
+        ASSERT_FALSE(info.fallback);
+        ASSERT_LT(info.residual, 1e-10);
+        ASSERT_LE(relative_error(refined, x), 1e-9);
+    }
+}
+
+TEST(PerfSolve, QrAndLeastSquares) {
+    std::mt19937 gen(perf_seed());
+    int dims[][2] = {{1, 1}, {17, 16}, {300, 300}, {1024, 33}, {1000, 7}, {129, 64}};
+    for (const auto& dim : dims) {
+        int m = dim[0], n = dim[1];
+        SCOPED_TRACE(testing::Message() << m << "x" << n << " seed " << perf_seed());
+        S21Matrix a = random_matrix(gen, m, n);
+        S21Qr qr = a.qr();
+        ASSERT_LE(relative_error(qr.q * qr.r, a), 1e-12);
+        ASSERT_LE(relative_error(qr.q.transpose() * qr.q, identity(n)), 1e-12);
+        for (int i = 1; i < n; i++) ASSERT_EQ(0.0, qr.r(i, i - 1));
+        // the residual of a least squares solution is orthogonal to the range of A
+        S21Matrix b = random_matrix(gen, m, 2);
+        S21Matrix residual = a * a.lstsq(b) - b;
+        ASSERT_LE((a.transpose() * residual).max_abs(), 1e-10 * m);
+    }
+}
+
+TEST(PerfSpectral, EigenAndSvd) {
+    std::mt19937 gen(perf_seed());
+    for (int n : {1, 5, 16, 64, 129}) {
+        SCOPED_TRACE(testing::Message() << "n = " << n << " seed " << perf_seed());
+        S21Matrix a = random_symmetric(gen, n);
+        S21Eigen eigen = a.eigen_symmetric();
+        S21Matrix scaled(eigen.vectors);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) scaled(i, j) *= eigen.values(j, 0);
+        }
+        ASSERT_LE((a * eigen.vectors - scaled).max_abs(), 1e-10 * a.max_abs() * n);
+        ASSERT_NEAR(a.trace(), eigen.values.sum(), 1e-10 * n);
+    }
+    int dims[][2] = {{200, 50}, {50, 200}, {33, 33}};
+    for (const auto& dim : dims) {
+        SCOPED_TRACE(testing::Message() << dim[0] << "x" << dim[1] << " seed " << perf_seed());
+        S21Matrix a = random_matrix(gen, dim[0], dim[1]);
+        S21Svd svd = a.svd();
+        int k = svd.s.get_rows();
+        S21Matrix scaled(svd.u);
+        for (int i = 0; i < scaled.get_rows(); i++) {
+            for (int j = 0; j < k; j++) scaled(i, j) *= svd.s(j, 0);
+        }
+        ASSERT_LE(relative_error(scaled * svd.v.transpose(), a), 1e-9);
+        for (int j = 1; j < k; j++) ASSERT_LE(svd.s(j, 0), svd.s(j - 1, 0));
+        S21Svd gram = a.svd(5, S21SvdMethod::kGram);
+        for (int j = 0; j < 5; j++) ASSERT_NEAR(svd.s(j, 0), gram.s(j, 0), 1e-10 * svd.s(0, 0));
+        S21Matrix gram_scaled(gram.u);
+        for (int i = 0; i < gram_scaled.get_rows(); i++) {
+            for (int j = 0; j < 5; j++) gram_scaled(i, j) *= gram.s(j, 0);
+        }
+        ASSERT_LE(relative_error(a * gram.v, gram_scaled), 1e-9);
+    }
+}
+
+TEST(PerfCofactor, DeterminantAndInverse) {
+    std::mt19937 gen(perf_seed());
+    for (int n = 1; n <= 8; n++) {
+        SCOPED_TRACE(testing::Message() << "n = " << n << " seed " << perf_seed());
+        S21Matrix a = random_regular(gen, n);
+        double det = reference_determinant(a);
+        ASSERT_NEAR(det, a.determinant(), 1e-12 * fabs(det));
+        ASSERT_LE(relative_error(a * a.inverse_matrix(), identity(n)), 1e-12);
+    }
+}
+
+TEST(PerfPower, PowAndExpm) {
+    std::mt19937 gen(perf_seed());
+    for (int n : {1, 3, 16, 65}) {
+        SCOPED_TRACE(testing::Message() << "n = " << n << " seed " << perf_seed());
+        S21Matrix a = random_matrix(gen, n, n) * (1.0 / n);
+        S21Matrix repeated = identity(n);
+        for (int k = 0; k <= 13; k++) {
+            ASSERT_LE(relative_error(a.pow(k), repeated), 1e-12);
+            repeated = reference_mul(repeated, a);
+        }
+        for (double scale : {0.01, 1.0, 40.0}) {
+            S21Matrix m = a * scale;
+            ASSERT_LE(relative_error(m.expm() * (m * -1.0).expm(), identity(n)), 1e-9 * (1.0 + scale));
+        }
+    }
+}
+
+// Budgets are about ten times the best time measured on a single core with the
+// -O2 build of make perf-test, so they catch algorithmic regressions, not noise.
+TEST(PerfBudget, Operations) {
+    std::mt19937 gen(perf_seed());
+    struct Budget {
+        const char* name;
+        int n;
+        double ms;
+    };
+    const Budget budgets[] = {{"mul", 256, 250},          {"mul", 512, 1500},
+                              {"mul", 1024, 10000},       {"transpose", 1024, 150},
+                              {"sum_matrix", 1024, 150},  {"copy_detach", 1024, 150},
+                              {"sum", 1024, 30},          {"norm_frobenius", 1024, 40},
+                              {"fingerprint", 1024, 30},  {"solve", 512, 500},
+                              {"solve_refined", 512, 500}, {"qr", 1024, 200},
+                              {"eigen", 128, 150},        {"expm", 128, 150},
+                              {"determinant", 8, 30}};
+    for (const Budget& budget : budgets) {
+        int n = budget.n;
+        std::string name = budget.name;
+        S21Matrix a;
+        if (name == "determinant" || name.rfind("solve", 0) == 0) {
+            a = random_regular(gen, n);
+        } else if (name == "eigen") {
+            a = random_symmetric(gen, n);
+        } else if (name == "expm") {
+            a = random_matrix(gen, n, n) * (1.0 / n);
+        } else if (name == "qr") {
+            a = random_matrix(gen, n, 64);
+        } else {
+            a = random_matrix(gen, n, n);
+        }
+        // the solvers get a single right-hand side, the binary operations a second operand
+        S21Matrix b = random_matrix(gen, a.get_rows(), name.rfind("solve", 0) == 0 ? 1 : a.get_cols());
+        double ms = best_ms([&] {
+            if (name == "mul") sink = (a * b)(0, 0);
+            if (name == "transpose") sink = a.transpose()(0, 0);
+            if (name == "sum_matrix") sink = (a + b)(0, 0);
+            if (name == "copy_detach") {
+                S21Matrix copy(a);
+                copy(0, 0) = 1.0;
+                sink = copy(n - 1, n - 1);
+            }
+            if (name == "sum") sink = a.sum();
+            if (name == "norm_frobenius") sink = a.norm_frobenius();
+            if (name == "fingerprint") {
+                b(0, 0) += 0.0;
+                sink = static_cast<double>(b.fingerprint());
+            }
+            if (name == "solve") sink = a.solve(b)(0, 0);
+            if (name == "solve_refined") sink = a.solve_refined(b)(0, 0);
+            if (name == "qr") sink = a.qr().r(0, 0);
+            if (name == "eigen") sink = a.eigen_symmetric().values(0, 0);
+            if (name == "expm") sink = a.expm()(0, 0);
+            if (name == "determinant") sink = a.determinant();
+        });
+        RecordProperty(name + "_" + std::to_string(n) + "_ms", std::to_string(ms));
+        EXPECT_LE(ms, budget.ms * budget_scale()) << name << " at n = " << n;
+    }
+}
+
+int main(int argc, char **argv) {
+    setenv("S21_THREADS", "4", 0);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,6 +1,34 @@
 #include <gtest/gtest.h>
 
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include "s21_matrix_oop.h"
+#include "s21_thread_pool.h"
+
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+bool comp_near(double a, double b) { return fabs(a - b) <= E * fmax(1.0, fabs(a)); }
+
+DetachedTask await_into(S21MatrixAwaiter awaiter, std::promise<S21Matrix>* out) {
+    try {
+        out->set_value(co_await awaiter);
+    } catch (...) {
+        out->set_exception(std::current_exception());
+    }
+}
 
 TEST(DefaultConstructorTest, SingleTest) {
     S21Matrix t1;
@@ -48,6 +76,21 @@ TEST(MoveConstructor, SingleTest) {
     ASSERT_EQ(2, t2.get_cols());
     ASSERT_EQ(0, t1.get_rows());
     ASSERT_EQ(0, t1.get_cols());
+    S21Matrix t3(std::move(t2));
+    ASSERT_TRUE(t1 == t2);
+    ASSERT_FALSE(t1 == t3);
+    ASSERT_EQ(t1.fingerprint(), t2.fingerprint());
+    ASSERT_EQ(0.0, t1.sum());
+    ASSERT_EQ(0.0, t1.dot(t2));
+    ASSERT_EQ(0.0, t1.norm_frobenius());
+    ASSERT_TRUE(isnan(t1.max()));
+    S21Matrix transposed = t1.transpose();
+    ASSERT_EQ(1, transposed.get_rows());
+    ASSERT_EQ(0.0, transposed(0, 0));
+    ASSERT_EQ(0.0, t1.norm_one());
+    ASSERT_EQ(0.0, t1.norm_inf());
+    ASSERT_EQ(0.0, t1.row_sums()(0, 0));
+    ASSERT_EQ(0.0, t1.col_sums()(0, 0));
 }
 
 TEST(EqualMatrix, CorrectInput) {
@@ -74,6 +117,59 @@ TEST(EqualMatrix, DifferentValues) {
     ASSERT_EQ(0, t1.eq_matrix(t2));
 }
 
+TEST(EqualMatrix, CompareModes) {
+    S21Matrix t1(1, 2);
+    S21Matrix t2(1, 2);
+    t1(0, 0) = 1e12;
+    t2(0, 0) = 1e12 + 1;
+    t1(0, 1) = 1.0;
+    t2(0, 1) = nextafter(nextafter(1.0, 2.0), 2.0);
+    ASSERT_EQ(0, t1.eq_matrix(t2, S21Compare::kAbsolute, E));
+    ASSERT_EQ(1, t1.eq_matrix(t2, S21Compare::kRelative, 1e-9));
+    ASSERT_EQ(0, t1.eq_matrix(t2, S21Compare::kUlp, 2));
+    t2(0, 0) = 1e12;
+    ASSERT_EQ(1, t1.eq_matrix(t2, S21Compare::kUlp, 2));
+    ASSERT_EQ(0, t1.eq_matrix(t2, S21Compare::kUlp, 1));
+    t2(0, 1) = 2.0;
+    ASSERT_EQ(1, t1.eq_matrix(t2, S21Compare::kNorm, 1e-9));
+    ASSERT_EQ(0, t1.eq_matrix(t2, S21Compare::kNorm, 1e-14));
+    t1(0, 0) = 1e200;
+    t2(0, 0) = -1e200;
+    ASSERT_EQ(0, t1.eq_matrix(t2, S21Compare::kNorm, 1e-12));
+    t2(0, 0) = 1e200;
+    ASSERT_EQ(1, t1.eq_matrix(t2, S21Compare::kNorm, 1e-12));
+}
+
+TEST(EqualMatrix, NanNeverEqual) {
+    S21Matrix t1(2, 2);
+    t1(0, 0) = NAN;
+    S21Matrix t2(t1);
+    ASSERT_EQ(0, t1 == t2);
+    ASSERT_EQ(0, t1.eq_matrix(t1, S21Compare::kUlp, 0));
+    ASSERT_EQ(0, t1.eq_matrix(t2, S21Compare::kNorm, 1.0));
+    ASSERT_EQ(t1.fingerprint(), t2.fingerprint());
+}
+
+TEST(Fingerprint, TracksWrites) {
+    S21Matrix t1(20, 3);
+    t1(19, 2) = 1.5;
+    S21Matrix t2(t1);
+    S21Matrix t3(20, 3);
+    t3(19, 2) = 1.5;
+    ASSERT_EQ(t1.fingerprint(), t2.fingerprint());
+    ASSERT_EQ(t1.fingerprint(), t3.fingerprint());
+    t2(0, 0) = 1e-300;
+    ASSERT_NE(t1.fingerprint(), t2.fingerprint());
+    ASSERT_EQ(0, t1.eq_matrix(t2, S21Compare::kAbsolute, 0.0));
+    ASSERT_EQ(1, t1 == t2);
+    ASSERT_NE(S21Matrix(3, 20).fingerprint(), S21Matrix(20, 3).fingerprint());
+    // equal cached hashes are not taken as equality
+    double* raw = t3.data();
+    ASSERT_EQ(t1.fingerprint(), t3.fingerprint());
+    raw[0] = 5;
+    ASSERT_EQ(0, t1 == t3);
+}
+
 TEST(SumMatrix, CorrectInput) {
     S21Matrix t1(2, 2);
     S21Matrix t2(2, 2);
@@ -344,6 +440,24 @@ TEST(DeterminantMatrix, MatrixSqrFour) {
     ASSERT_NEAR(res, -15264, E);
 }
 
+TEST(ScratchPool, ReusesMinors) {
+    S21Matrix t1(6, 6);
+    for (int i = 0; i < 6; i++) {
+        for (int j = 0; j < 6; j++) t1(i, j) = (i + 1) * (j + 2) % 5 + (i == j);
+    }
+    double det = t1.determinant();
+    S21ScratchStats before = S21Matrix::scratch_stats();
+    ASSERT_NEAR(det, t1.determinant(), E);
+    S21Matrix complements = t1.calc_complements();
+    S21ScratchStats after = S21Matrix::scratch_stats();
+    ASSERT_EQ(before.misses, after.misses);
+    ASSERT_GT(after.hits, before.hits);
+    ASSERT_GE(after.cached, 4UL);
+    double expansion = 0.0;
+    for (int j = 0; j < 6; j++) expansion += complements(0, j) * t1(0, j);
+    ASSERT_NEAR(det, expansion, E);
+}
+
 TEST(InverseMatrix, SqrMatrixOne) {
     S21Matrix t1(1, 1);
     t1(0, 0) = 5;
@@ -667,6 +781,47 @@ TEST(Mutator, SingleTest) {
     t1.set_rows(2);
 }
 
+TEST(Mutator, KeepsValues) {
+    S21Matrix t1(2, 2);
+    t1(0, 0) = 1;
+    t1(1, 1) = 2;
+    t1.set_rows(3);
+    t1.set_cols(1);
+    ASSERT_NEAR(1, t1(0, 0), E);
+    ASSERT_NEAR(0, t1(1, 0), E);
+    ASSERT_NEAR(0, t1(2, 0), E);
+    ASSERT_THROW(t1.set_rows(0), ExceptionError);
+}
+
+TEST(CopyOnWrite, WriteDetaches) {
+    S21Matrix t1(2, 2);
+    t1(0, 0) = 1;
+    S21Matrix t2(t1);
+    S21Matrix t3;
+    t3 = t1;
+    t2(0, 0) = 2;
+    t3 += t1;
+    ASSERT_NEAR(1, t1(0, 0), E);
+    ASSERT_NEAR(2, t2(0, 0), E);
+    ASSERT_NEAR(2, t3(0, 0), E);
+    t1 = t1;
+    ASSERT_NEAR(1, t1(0, 0), E);
+}
+
+TEST(CopyOnWrite, ReadKeepsSharing) {
+    S21Matrix t1(2, 2);
+    t1(0, 1) = 3;
+    S21Matrix t2(t1);
+    double value = t2(0, 1);
+    const S21Matrix& view = t2;
+    ASSERT_EQ(3.0, value);
+    ASSERT_EQ(std::as_const(t1).data(), view.data());
+    t2(1, 1) += t2(0, 1);
+    ASSERT_NE(std::as_const(t1).data(), view.data());
+    ASSERT_EQ(3.0, t2(1, 1));
+    ASSERT_EQ(0.0, t1(1, 1));
+}
+
 TEST(OperatorMulNumberByMatrix, SingleTest) {
     S21Matrix t1(2, 2);
     t1(0, 0) = 2;
@@ -682,6 +837,638 @@ TEST(OperatorMulNumberByMatrix, SingleTest) {
     ASSERT_EQ(2, t3.get_cols());
 }
 
+TEST(MulAsync, SqrMatrix) {
+    S21Matrix t1(3, 3);
+    S21Matrix t2(3, 3);
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            t1(i, j) = i + 2 * j;
+            t2(i, j) = i - j;
+        }
+    }
+    double last = 0.0;
+    std::promise<S21Matrix> out;
+    await_into(t1.mul_async(t2, {}, [&last](double done) { last = done; }), &out);
+    S21Matrix t3 = out.get_future().get();
+    ASSERT_EQ(1, t3 == t1 * t2);
+    ASSERT_NEAR(1.0, last, E);
+}
+
+TEST(MulAsync, Cancelled) {
+    S21Matrix t1(2, 2);
+    std::stop_source source;
+    source.request_stop();
+    std::promise<S21Matrix> out;
+    await_into(t1.mul_async(t1, source.get_token()), &out);
+    ASSERT_THROW(out.get_future().get(), ExceptionError);
+}
+
+TEST(MulAsync, IncorrectInput) {
+    S21Matrix t1(2, 3);
+    S21Matrix t2(2, 3);
+    ASSERT_THROW(t1.mul_async(t2), ExceptionError);
+}
+
+TEST(InverseAsync, SqrMatrixThree) {
+    S21Matrix t1(3, 3);
+    t1(0, 0) = 2;
+    t1(0, 1) = 5;
+    t1(0, 2) = 7;
+    t1(1, 0) = 6;
+    t1(1, 1) = 3;
+    t1(1, 2) = 4;
+    t1(2, 0) = 5;
+    t1(2, 1) = -2;
+    t1(2, 2) = -3;
+    std::promise<S21Matrix> out;
+    await_into(t1.inverse_async(), &out);
+    S21Matrix t2 = out.get_future().get();
+    ASSERT_EQ(1, t2 == t1.inverse_matrix());
+}
+
+TEST(Reductions, SmallMatrix) {
+    S21Matrix t1(2, 3);
+    t1(0, 0) = 1;
+    t1(0, 1) = -4;
+    t1(0, 2) = 2;
+    t1(1, 0) = 3;
+    t1(1, 1) = 0;
+    t1(1, 2) = -1;
+    ASSERT_NEAR(1, t1.sum(), E);
+    ASSERT_NEAR(-4, t1.min(), E);
+    ASSERT_NEAR(3, t1.max(), E);
+    ASSERT_NEAR(4, t1.max_abs(), E);
+    ASSERT_NEAR(sqrt(31.0), t1.norm_frobenius(), E);
+    ASSERT_NEAR(4, t1.norm_one(), E);
+    ASSERT_NEAR(7, t1.norm_inf(), E);
+    ASSERT_NEAR(31, t1.dot(t1), E);
+    S21Matrix rows = t1.row_sums();
+    ASSERT_EQ(2, rows.get_rows());
+    ASSERT_NEAR(-1, rows(0, 0), E);
+    ASSERT_NEAR(2, rows(1, 0), E);
+    S21Matrix cols = t1.col_sums();
+    ASSERT_EQ(3, cols.get_cols());
+    ASSERT_NEAR(4, cols(0, 0), E);
+    ASSERT_NEAR(1, cols(0, 2), E);
+    S21Matrix means = t1.col_means();
+    ASSERT_NEAR(-2, means(0, 1), E);
+    S21Matrix variances = t1.col_variances();
+    ASSERT_NEAR(1, variances(0, 0), E);
+    ASSERT_NEAR(4, variances(0, 1), E);
+    ASSERT_NEAR(2.25, variances(0, 2), E);
+    ASSERT_THROW(t1.trace(), ExceptionError);
+    S21Matrix t2(2, 2);
+    t2(0, 0) = 1.5;
+    t2(1, 1) = -3;
+    ASSERT_NEAR(-1.5, t2.trace(), E);
+    ASSERT_THROW(t1.dot(S21Matrix(3, 2)), ExceptionError);
+}
+
+TEST(Reductions, LargeMatrix) {
+    S21Matrix t1(300, 302);
+    for (int i = 0; i < 300; i++) {
+        for (int j = 0; j < 302; j++) {
+            t1(i, j) = 1e8 + (i * 302 + j) % 7 - 3 + 0.1;
+        }
+    }
+    long n = 300L * 302;
+    double expected = 0.0;
+    for (long k = 0; k < n; k++) expected += k % 7 - 3;
+    ASSERT_NEAR(1e8 * n + expected + 0.1 * n, t1.sum(), 1e-2);
+    ASSERT_NEAR(1e8 + 3.1, t1.max(), E);
+    ASSERT_NEAR(1e8 - 2.9, t1.min(), E);
+    S21Matrix variances = t1.col_variances();
+    ASSERT_NEAR(4.0, variances(0, 0), 0.1);
+}
+
+TEST(Solve, SqrMatrixThree) {
+    S21Matrix a(3, 3);
+    S21Matrix b(3, 1);
+    a(0, 0) = 0;
+    a(0, 1) = 2;
+    a(0, 2) = 1;
+    a(1, 0) = 1;
+    a(1, 1) = -1;
+    a(1, 2) = 0;
+    a(2, 0) = 3;
+    a(2, 1) = 0;
+    a(2, 2) = 4;
+    b(0, 0) = 7;
+    b(1, 0) = -1;
+    b(2, 0) = 15;
+    S21Matrix x = a.solve(b);
+    ASSERT_NEAR(1, x(0, 0), E);
+    ASSERT_NEAR(2, x(1, 0), E);
+    ASSERT_NEAR(3, x(2, 0), E);
+    ASSERT_NEAR(0, a(0, 0), E);
+    ASSERT_NEAR(7, b(0, 0), E);
+    ASSERT_THROW(S21Matrix(3, 3).solve(b), ExceptionError);
+    ASSERT_THROW(a.solve(S21Matrix(2, 1)), ExceptionError);
+}
+
+TEST(SolveRefined, ConvergesInFloat) {
+    const int n = 120;
+    S21Matrix a(n, n), b(n, 2);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) a(i, j) = sin(i * 0.37 + j * 1.91) + (i == j) * n / 4.0;
+        b(i, 0) = cos(i * 0.5);
+        b(i, 1) = i % 7 - 3.0;
+    }
+    S21RefineInfo info;
+    S21Matrix x = a.solve_refined(b, &info);
+    ASSERT_FALSE(info.fallback);
+    ASSERT_GE(info.iterations, 1);
+    ASSERT_LE(info.iterations, 5);
+    ASSERT_LT(info.residual, 1e-12);
+    ASSERT_TRUE(x.eq_matrix(a.solve(b), S21Compare::kRelative, 1e-9));
+    ASSERT_THROW(a.solve_refined(S21Matrix(n - 1, 1)), ExceptionError);
+}
+
+TEST(SolveRefined, FallsBackWhenIllConditioned) {
+    const int n = 10;
+    S21Matrix hilbert(n, n), b(n, 1);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) hilbert(i, j) = 1.0 / (i + j + 1);
+        b(i, 0) = 1.0;
+    }
+    S21RefineInfo info;
+    S21Matrix x = hilbert.solve_refined(b, &info);
+    ASSERT_TRUE(info.fallback);
+    ASSERT_TRUE(x == hilbert.solve(b));
+    ASSERT_LT(info.residual, 1e-12);
+}
+
+TEST(Pow, Fibonacci) {
+    S21Matrix t1(2, 2);
+    t1(0, 0) = 1;
+    t1(0, 1) = 1;
+    t1(1, 0) = 1;
+    S21Matrix t2 = t1.pow(10);
+    ASSERT_NEAR(89, t2(0, 0), E);
+    ASSERT_NEAR(55, t2(0, 1), E);
+    ASSERT_NEAR(34, t2(1, 1), E);
+    S21Matrix t3 = t1.pow(0);
+    ASSERT_NEAR(1, t3(0, 0), E);
+    ASSERT_NEAR(0, t3(0, 1), E);
+    S21Matrix loop(t1);
+    for (int i = 1; i < 13; i++) loop *= t1;
+    ASSERT_EQ(1, t1.pow(13) == loop);
+    ASSERT_NEAR(1, t1(0, 0), E);
+    ASSERT_THROW(t1.pow(-1), ExceptionError);
+    ASSERT_THROW(S21Matrix(2, 3).pow(2), ExceptionError);
+}
+
+TEST(Expm, KnownMatrices) {
+    S21Matrix t1(2, 2);
+    t1(0, 1) = 1;
+    S21Matrix t2 = t1.expm();
+    ASSERT_NEAR(1, t2(0, 0), E);
+    ASSERT_NEAR(1, t2(0, 1), E);
+    ASSERT_NEAR(0, t2(1, 0), E);
+    for (double angle : {0.001, 0.5, 2.0, 10.0}) {
+        S21Matrix rot(2, 2);
+        rot(0, 1) = -angle;
+        rot(1, 0) = angle;
+        S21Matrix r = rot.expm();
+        ASSERT_NEAR(cos(angle), r(0, 0), 1e-12);
+        ASSERT_NEAR(-sin(angle), r(0, 1), 1e-12);
+        ASSERT_NEAR(sin(angle), r(1, 0), 1e-12);
+    }
+    S21Matrix diag(3, 3);
+    diag(0, 0) = -20;
+    diag(1, 1) = 0.1;
+    diag(2, 2) = 3;
+    S21Matrix d = diag.expm();
+    ASSERT_NEAR(exp(-20.0), d(0, 0), 1e-15);
+    ASSERT_NEAR(exp(3.0), d(2, 2), 1e-12);
+    ASSERT_THROW(S21Matrix(2, 3).expm(), ExceptionError);
+}
+
+TEST(EigenSymmetric, SqrMatrixThree) {
+    S21Matrix t1(3, 3);
+    for (int i = 0; i < 3; i++) {
+        t1(i, i) = 2;
+        if (i > 0) t1(i, i - 1) = t1(i - 1, i) = 1;
+    }
+    S21Eigen eigen = t1.eigen_symmetric();
+    ASSERT_EQ(3, eigen.values.get_rows());
+    ASSERT_NEAR(2 + sqrt(2.0), eigen.values(0, 0), E);
+    ASSERT_NEAR(2, eigen.values(1, 0), E);
+    ASSERT_NEAR(2 - sqrt(2.0), eigen.values(2, 0), E);
+    S21Matrix diag(3, 3);
+    for (int i = 0; i < 3; i++) diag(i, i) = eigen.values(i, 0);
+    S21Matrix vt = eigen.vectors.transpose();
+    ASSERT_EQ(1, eigen.vectors * diag * vt == t1);
+    ASSERT_THROW(S21Matrix(2, 3).eigen_symmetric(), ExceptionError);
+}
+
+TEST(EigenSymmetric, TopComponents) {
+    const int n = 40;
+    S21Matrix t1(n, n);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j <= i; j++) {
+            t1(i, j) = t1(j, i) = ((i * 31 + j * 17) % 23) / 7.0 - 1.5;
+        }
+    }
+    S21Eigen full = t1.eigen_symmetric();
+    S21Eigen top = t1.eigen_symmetric(3);
+    ASSERT_EQ(3, top.values.get_rows());
+    ASSERT_EQ(n, top.vectors.get_rows());
+    ASSERT_EQ(3, top.vectors.get_cols());
+    for (int c = 0; c < 3; c++) {
+        ASSERT_NEAR(full.values(c, 0), top.values(c, 0), E);
+        S21Matrix v(n, 1);
+        for (int i = 0; i < n; i++) v(i, 0) = top.vectors(i, c);
+        S21Matrix residual = t1 * v - v * top.values(c, 0);
+        ASSERT_NEAR(0, residual.norm_frobenius(), E);
+        ASSERT_NEAR(1, v.norm_frobenius(), E);
+    }
+}
+
+TEST(EigenSymmetric, ClusterNextToLargeValues) {
+    // A^T A has a few eigenvalues near 1e4 and a cluster of ones
+    S21Matrix t1(1000, 100);
+    for (int i = 0; i < 1000; i++) {
+        for (int j = 0; j < 100; j++) {
+            t1(i, j) = ((i * 31 + j * 17) % 23) / 7.0 - 1.5 + (i == j);
+        }
+    }
+    S21Matrix gram = t1.transpose() * t1;
+    S21Eigen eigen = gram.eigen_symmetric();
+    ASSERT_NEAR(gram.trace(), eigen.values.sum(), 1e-9 * gram.trace());
+    S21Matrix scaled(eigen.vectors);
+    for (int i = 0; i < 100; i++) {
+        for (int j = 0; j < 100; j++) scaled(i, j) *= eigen.values(j, 0);
+    }
+    ASSERT_LE((gram * eigen.vectors - scaled).max_abs(), 1e-10 * gram.max_abs());
+}
+
+TEST(Svd, TallAndWide) {
+    S21Matrix t1(5, 3);
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 3; j++) {
+            t1(i, j) = (i + 1) * (j + 2) % 7 - 2.5;
+        }
+    }
+    for (S21Matrix m : {t1, t1.transpose()}) {
+        S21Svd svd = m.svd();
+        ASSERT_EQ(3, svd.s.get_rows());
+        ASSERT_EQ(m.get_rows(), svd.u.get_rows());
+        ASSERT_EQ(m.get_cols(), svd.v.get_rows());
+        S21Matrix diag(3, 3);
+        for (int i = 0; i < 3; i++) diag(i, i) = svd.s(i, 0);
+        ASSERT_GE(svd.s(0, 0), svd.s(1, 0));
+        ASSERT_GE(svd.s(1, 0), svd.s(2, 0));
+        S21Matrix vt = svd.v.transpose();
+        ASSERT_EQ(1, svd.u * diag * vt == m);
+        S21Svd top = m.svd(1);
+        ASSERT_NEAR(svd.s(0, 0), top.s(0, 0), E);
+        ASSERT_EQ(1, top.u.get_cols());
+        S21Svd gram = m.svd(2, S21SvdMethod::kGram);
+        ASSERT_EQ(2, gram.s.get_rows());
+        ASSERT_EQ(m.get_rows(), gram.u.get_rows());
+        ASSERT_EQ(m.get_cols(), gram.v.get_rows());
+        S21Matrix gram_s(2, 2);
+        for (int i = 0; i < 2; i++) {
+            ASSERT_NEAR(svd.s(i, 0), gram.s(i, 0), E);
+            gram_s(i, i) = gram.s(i, 0);
+        }
+        ASSERT_EQ(1, m * gram.v == gram.u * gram_s);
+        S21Matrix eye(2, 2);
+        for (int i = 0; i < 2; i++) eye(i, i) = 1.0;
+        ASSERT_TRUE(gram.u.transpose() * gram.u == eye);
+    }
+}
+
+TEST(Svd, TinySingularValues) {
+    // A = U diag(1, 1e-2, ..., 1e-14) V^T with orthonormal U (40 x 8) and V (8 x 8)
+    S21Matrix g1(40, 8), g2(8, 8);
+    for (int i = 0; i < 40; i++) {
+        for (int j = 0; j < 8; j++) {
+            g1(i, j) = sin(i * 1.3 + j * 0.7 + 0.1 * i * j);
+            if (i < 8) g2(i, j) = cos(i * 2.1 - j * 0.9 + 0.3 * i * j);
+        }
+    }
+    S21Matrix u = g1.qr().q, v = g2.qr().q;
+    S21Matrix scaled(u);
+    for (int j = 0; j < 8; j++) {
+        for (int i = 0; i < 40; i++) scaled(i, j) *= ::pow(10.0, -2.0 * j);
+    }
+    S21Matrix a = scaled * v.transpose();
+    S21Svd svd = a.svd();
+    for (int j = 0; j < 8; j++) {
+        ASSERT_NEAR(::pow(10.0, -2.0 * j), svd.s(j, 0), 1e-15);
+    }
+    ASSERT_NEAR(1e-10, svd.s(5, 0), 1e-12);
+    S21Matrix eye(8, 8);
+    for (int i = 0; i < 8; i++) eye(i, i) = 1.0;
+    ASSERT_TRUE(svd.u.transpose() * svd.u == eye);
+    ASSERT_TRUE(svd.v.transpose() * svd.v == eye);
+}
+
+TEST(Svd, RankDeficient) {
+    S21Matrix t1(5, 3);
+    for (int i = 0; i < 5; i++) {
+        t1(i, 0) = i + 1;
+        t1(i, 2) = 2 * (i + 1);
+    }
+    for (S21Matrix m : {t1, t1.transpose()}) {
+        S21Svd svd = m.svd();
+        ASSERT_NEAR(0.0, svd.s(1, 0), E);
+        ASSERT_NEAR(0.0, svd.s(2, 0), E);
+        S21Matrix eye(3, 3);
+        for (int i = 0; i < 3; i++) eye(i, i) = 1.0;
+        ASSERT_TRUE(svd.u.transpose() * svd.u == eye);
+        ASSERT_TRUE(svd.v.transpose() * svd.v == eye);
+        S21Svd gram = m.svd(0, S21SvdMethod::kGram);
+        ASSERT_NEAR(svd.s(0, 0), gram.s(0, 0), E);
+        ASSERT_TRUE(gram.u.transpose() * gram.u == eye);
+        ASSERT_TRUE(gram.v.transpose() * gram.v == eye);
+    }
+}
+
+TEST(Qr, TallMatrix) {
+    S21Matrix t1(6, 3);
+    for (int i = 0; i < 6; i++) {
+        for (int j = 0; j < 3; j++) {
+            t1(i, j) = (i * 5 + j * 3) % 7 - 3.0 + (i == j);
+        }
+    }
+    S21Qr qr = t1.qr();
+    ASSERT_EQ(6, qr.q.get_rows());
+    ASSERT_EQ(3, qr.q.get_cols());
+    ASSERT_EQ(3, qr.r.get_rows());
+    ASSERT_NEAR(0, qr.r(2, 0), E);
+    ASSERT_NEAR(0, qr.r(1, 0), E);
+    S21Matrix identity(3, 3);
+    for (int i = 0; i < 3; i++) identity(i, i) = 1;
+    ASSERT_EQ(1, qr.q.transpose() * qr.q == identity);
+    ASSERT_EQ(1, qr.q * qr.r == t1);
+    ASSERT_THROW(S21Matrix(2, 3).qr(), ExceptionError);
+}
+
+TEST(Lstsq, LineFit) {
+    S21Matrix a(4, 2);
+    S21Matrix b(4, 1);
+    double y[4] = {1.0, 3.0, 2.0, 5.0};
+    for (int i = 0; i < 4; i++) {
+        a(i, 0) = 1;
+        a(i, 1) = i;
+        b(i, 0) = y[i];
+    }
+    S21Matrix x = a.lstsq(b);
+    ASSERT_EQ(2, x.get_rows());
+    ASSERT_NEAR(1.1, x(0, 0), E);
+    ASSERT_NEAR(1.1, x(1, 0), E);
+    ASSERT_THROW(a.lstsq(S21Matrix(3, 1)), ExceptionError);
+    S21Matrix rank_one(3, 2);
+    ASSERT_THROW(rank_one.lstsq(S21Matrix(3, 1)), ExceptionError);
+}
+
+TEST(Lstsq, TallSkinnyBlocks) {
+    const int m = 3000, n = 30;
+    S21Matrix a(m, n);
+    S21Matrix expected(n, 2);
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            a(i, j) = sin(i * 0.37 + j * 1.91) + (i % n == j);
+        }
+    }
+    for (int j = 0; j < n; j++) {
+        expected(j, 0) = j - 10.5;
+        expected(j, 1) = 1.0 / (j + 1);
+    }
+    S21Matrix x = a.lstsq(a * expected);
+    ASSERT_EQ(1, x.eq_matrix(expected, S21Compare::kAbsolute, 1e-9));
+    S21Qr qr = a.qr();
+    ASSERT_EQ(1, qr.q * qr.r == a);
+    ASSERT_NEAR(sqrt(static_cast<double>(n)), qr.q.norm_frobenius(), E);
+}
+
+TEST(ConstAccess, ReadOnlyMatrix) {
+    S21Matrix t1(2, 2);
+    t1(0, 0) = 3;
+    t1(1, 1) = 2;
+    const S21Matrix& t2 = t1;
+    ASSERT_NEAR(3, t2(0, 0), E);
+    ASSERT_EQ(2, t2.get_rows());
+    ASSERT_NEAR(6, t2.determinant(), E);
+    ASSERT_EQ(1, t2.transpose() == t2);
+    ASSERT_EQ(1, t2 * t2.inverse_matrix() == t2.calc_complements() * (1.0 / 6) * t2.transpose());
+    ASSERT_THROW(t2.at(2, 0), ExceptionError);
+}
+
+TEST(CheckedAccess, InformativeError) {
+    S21Matrix t1(2, 3);
+    t1.at(1, 2) = 4;
+    ASSERT_NEAR(4, t1(1, 2), E);
+    try {
+        t1.at(2, 0);
+        FAIL();
+    } catch (const ExceptionError& error) {
+        ASSERT_STREQ("S21Matrix: index (2, 0) is out of range for a 2x3 matrix", error.what());
+    }
+    try {
+        t1.sum_matrix(S21Matrix(3, 2));
+        FAIL();
+    } catch (const std::exception& error) {
+        ASSERT_STREQ("S21Matrix: dimensions of the operands differ (2x3 and 3x2)", error.what());
+    }
+    try {
+        t1.mul_matrix(t1);
+        FAIL();
+    } catch (const std::exception& error) {
+        ASSERT_STREQ("S21Matrix: cols of the left operand must equal rows of the right one (2x3 and 2x3)",
+                     error.what());
+    }
+#if S21_MATRIX_BOUNDS_CHECK
+    ASSERT_THROW(t1(-1, 0), ExceptionError);
+#endif
+}
+
+TEST(RawData, DetachesOnWrite) {
+    S21Matrix t1(2, 2);
+    S21Matrix t2(t1);
+    const S21Matrix& view = t1;
+    ASSERT_EQ(view.data(), static_cast<const S21Matrix&>(t2).data());
+    double* raw = t1.data();
+    for (int i = 0; i < 4; i++) raw[i] = i;
+    ASSERT_NEAR(2, t1(1, 0), E);
+    ASSERT_NEAR(0, t2(1, 0), E);
+}
+
+TEST(StatusApi, ReportsErrors) {
+    S21Matrix t1(2, 2);
+    S21Matrix t2(2, 3);
+    double value = 0.0;
+    t1(0, 0) = 2;
+    t1(1, 1) = 4;
+    ASSERT_EQ(S21Status::kOk, t1.try_at(1, 1, value));
+    ASSERT_NEAR(4, value, E);
+    ASSERT_EQ(S21Status::kOutOfRange, t1.try_at(2, 1, value));
+    ASSERT_EQ(S21Status::kDimensionMismatch, t1.try_sum_matrix(t2));
+    ASSERT_EQ(S21Status::kDimensionMismatch, t1.try_sub_matrix(t2));
+    ASSERT_EQ(S21Status::kDimensionMismatch, t2.try_mul_matrix(t1));
+    ASSERT_EQ(S21Status::kOk, t1.try_mul_matrix(t2));
+    ASSERT_EQ(S21Status::kNotSquare, t1.try_determinant(value));
+    S21Matrix square(2, 2);
+    square(0, 0) = 2;
+    square(1, 1) = 4;
+    ASSERT_EQ(S21Status::kOk, square.try_determinant(value));
+    ASSERT_NEAR(8, value, E);
+    S21Matrix inverse;
+    ASSERT_EQ(S21Status::kOk, square.try_inverse_matrix(inverse));
+    ASSERT_NEAR(0.25, inverse(1, 1), E);
+    ASSERT_EQ(S21Status::kSingular, S21Matrix(2, 2).try_inverse_matrix(inverse));
+    ASSERT_EQ(S21Status::kOk, square.try_sum_matrix(square));
+    ASSERT_NEAR(4, square(0, 0), E);
+}
+
+TEST(ConcurrentRead, SharedConstMatrix) {
+    const int n = 96;
+    S21Matrix source(n, n);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            source(i, j) = (i * 13 + j * 7) % 11 - 5.0 + (i == j) * n;
+        }
+    }
+    const S21Matrix& shared = source;
+    const S21Matrix square = shared * shared;
+    const double norm = shared.norm_frobenius();
+    const std::uint64_t hash = S21Matrix(shared).fingerprint();
+    std::vector<std::thread> readers;
+    std::atomic<int> failures{0};
+    for (int t = 0; t < 8; t++) {
+        readers.emplace_back([&, t] {
+            for (int round = 0; round < 4; round++) {
+                S21Matrix copy(shared);
+                copy(t, t) += 1.0;
+                if (shared(t, t) == copy(t, t)) failures++;
+                if (!(shared * shared == square)) failures++;
+                if (fabs(shared.norm_frobenius() - norm) > E) failures++;
+                if (shared.fingerprint() != hash) failures++;
+                if (!(shared.transpose().transpose() == shared)) failures++;
+                if (!shared.eq_matrix(copy, S21Compare::kNorm, 1.0)) failures++;
+                S21Matrix minor(3, 3);
+                for (int i = 0; i < 3; i++) {
+                    for (int j = 0; j < 3; j++) minor(i, j) = shared(i + t, j);
+                }
+                if (!comp_near(minor.determinant(), minor.transpose().determinant())) failures++;
+            }
+        });
+    }
+    for (auto& reader : readers) reader.join();
+    ASSERT_EQ(0, failures.load());
+}
+
+TEST(Uninitialized, OverwrittenResults) {
+    S21Matrix t1(3, 4, S21Uninitialized{});
+    ASSERT_EQ(3, t1.get_rows());
+    ASSERT_EQ(4, t1.get_cols());
+    for (int i = 0; i < 12; i++) t1.data()[i] = i;
+    S21Matrix t2 = t1.transpose();
+    ASSERT_EQ(7.0, t2(3, 1));
+    S21Matrix t3 = t1 * t2;
+    ASSERT_EQ(14.0, t3(0, 0));
+    ASSERT_EQ(1, S21Matrix(0, 2, S21Uninitialized{}).get_rows());
+}
+
+TEST(Uninitialized, LazyZeroPages) {
+    // 64 MiB: zero-filled by calloc instead of by the workers
+    S21Matrix big(1 << 12, 1 << 11);
+    ASSERT_EQ(0.0, big.max_abs());
+    big(4095, 2047) = 1.0;
+    S21Matrix copy(big);
+    copy(0, 0) = 2.0;
+    ASSERT_EQ(1.0, copy(4095, 2047));
+    ASSERT_EQ(0.0, big(0, 0));
+}
+
+TEST(NumaTopology, ParsesSysfsLayout) {
+    std::filesystem::create_directories("s21_numa/node0");
+    std::filesystem::create_directories("s21_numa/node2");
+    std::filesystem::create_directories("s21_numa/power");
+    std::ofstream("s21_numa/node0/cpulist") << "0-2,8\n";
+    std::ofstream("s21_numa/node2/cpulist") << "4\n";
+    std::vector<std::vector<int>> topology = S21ThreadPool::numa_topology("s21_numa");
+    std::filesystem::remove_all("s21_numa");
+    ASSERT_EQ(3u, topology.size());
+    ASSERT_EQ(std::vector<int>({0, 1, 2, 8}), topology[0]);
+    ASSERT_TRUE(topology[1].empty());
+    ASSERT_EQ(std::vector<int>({4}), topology[2]);
+    ASSERT_EQ(1u, S21ThreadPool::numa_topology("s21_numa").size());
+}
+
+TEST(NumaAllocation, FallsBackOnOneNode) {
+    bool multi_node = S21ThreadPool::instance().numa_nodes() > 1;
+    ASSERT_EQ(multi_node, S21Matrix::set_numa_interleave(true));
+    // large enough for the page-aligned, parallel first-touch path
+    const int n = 400;
+    S21Matrix big(n, n + 1);
+    ASSERT_EQ(0.0, big.sum());
+    ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(big.data()) % 4096);
+    for (int i = 0; i < n; i++) big(i, i) = 2.0;
+    S21Matrix product = big * big.transpose();
+    ASSERT_FALSE(S21Matrix::set_numa_interleave(false));
+    ASSERT_NEAR(4.0 * n, product.trace(), E);
+    ASSERT_EQ(0.0, product(0, 1));
+}
+
+TEST(FromCsv, CorrectInput) {
+    std::ofstream("s21_test.csv") << "1.5, -2,3\n4 5e1\t6\r\n\n";
+    S21CsvInfo info;
+    S21Matrix t1 = S21Matrix::from_csv("s21_test.csv", &info);
+    std::remove("s21_test.csv");
+    ASSERT_EQ(2, info.rows);
+    ASSERT_EQ(3, info.cols);
+    ASSERT_EQ(0, info.line);
+    ASSERT_EQ(2, t1.get_rows());
+    ASSERT_EQ(3, t1.get_cols());
+    ASSERT_NEAR(1.5, t1(0, 0), E);
+    ASSERT_NEAR(-2, t1(0, 1), E);
+    ASSERT_NEAR(50, t1(1, 1), E);
+    ASSERT_NEAR(6, t1(1, 2), E);
+}
+
+TEST(FromCsv, IncorrectInput) {
+    S21CsvInfo info;
+    std::ofstream("s21_test.csv") << "1,2\n3,4\n5,x\n";
+    try {
+        S21Matrix::from_csv("s21_test.csv", &info);
+        FAIL();
+    } catch (const ExceptionError& error) {
+        ASSERT_STREQ("S21Matrix: malformed CSV input at 3:3", error.what());
+    }
+    ASSERT_EQ(3, info.line);
+    ASSERT_EQ(3, info.column);
+    std::ofstream("s21_test.csv") << "1,2\n3\n";
+    ASSERT_THROW(S21Matrix::from_csv("s21_test.csv", &info), ExceptionError);
+    ASSERT_EQ(2, info.line);
+    ASSERT_EQ(2, info.column);
+    std::remove("s21_test.csv");
+    ASSERT_THROW(S21Matrix::from_csv("s21_test.csv", &info), ExceptionError);
+}
+
+TEST(ToCsv, RoundTrip) {
+    S21Matrix t1(2, 3);
+    t1(0, 0) = 0.1;
+    t1(0, 2) = -1e300;
+    t1(1, 1) = 1.0 / 3;
+    t1.to_csv("s21_test.csv");
+    S21Matrix t2 = S21Matrix::from_csv("s21_test.csv");
+    std::remove("s21_test.csv");
+    ASSERT_EQ(2, t2.get_rows());
+    ASSERT_EQ(3, t2.get_cols());
+    ASSERT_EQ(t1(0, 0), t2(0, 0));
+    ASSERT_EQ(t1(0, 2), t2(0, 2));
+    ASSERT_EQ(t1(1, 1), t2(1, 1));
+    t1.to_csv("s21_test.csv", ';');
+    ASSERT_THROW(S21Matrix::from_csv("s21_test.csv"), ExceptionError);
+    S21Matrix t3 = S21Matrix::from_csv("s21_test.csv", nullptr, ';');
+    std::remove("s21_test.csv");
+    ASSERT_TRUE(t1 == t3);
+}
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,88 @@
+#include <algorithm>
+
+#include "s21_matrix_oop.h"
+#include "s21_thread_pool.h"
+
+S21MatrixAwaiter::S21MatrixAwaiter(Job job, std::stop_token token, S21Progress progress)
+    : _job(std::move(job)), _token(std::move(token)), _progress(std::move(progress)) {}
+
+bool S21MatrixAwaiter::await_ready() const noexcept { return false; }
+
+void S21MatrixAwaiter::await_suspend(std::coroutine_handle<> caller) {
+    S21ThreadPool::instance().submit([this, caller] {
+        try {
+            if (_token.stop_requested()) {
+                throw ExceptionError("S21Matrix: operation cancelled");
+            }
+            _result.emplace(_job(_token, _progress));
+        } catch (...) {
+            _error = std::current_exception();
+        }
+        caller.resume();
+    });
+}
+
+S21Matrix S21MatrixAwaiter::await_resume() {
+    if (_error) {
+        std::rethrow_exception(_error);
+    }
+    return std::move(*_result);
+}
+
+S21MatrixAwaiter S21Matrix::mul_async(const S21Matrix& other, std::stop_token token,
+                                      S21Progress progress) const {
+    if (_cols != other._rows) {
+        shape_error("cols of the left operand must equal rows of the right one", &other);
+    }
+    auto job = [lhs = S21Matrix(*this), rhs = S21Matrix(other)](std::stop_token stop,
+                                                                 const S21Progress& report) {
+        S21Matrix result(lhs._rows, rhs._cols, S21Uninitialized{});
+        int grain = S21ThreadPool::grain(lhs._cols * rhs._cols);
+        // rows are handed out in blocks so cancellation and progress stay responsive
+        int step = grain * (S21ThreadPool::instance().size() + 1);
+        for (int i = 0; i < lhs._rows; i += step) {
+            if (stop.stop_requested()) {
+                throw ExceptionError("S21Matrix: operation cancelled");
+            }
+            int to = i + step < lhs._rows ? i + step : lhs._rows;
+            S21ThreadPool::instance().parallel_for(
+                i, to, grain, [&](int from, int end) {
+                    double* first = result._matrix[from];
+                    std::fill(first, first + static_cast<long>(end - from) * rhs._cols, 0.0);
+                    result.mul_rows(lhs, rhs, from, end);
+                });
+            if (report) report(static_cast<double>(to) / lhs._rows);
+        }
+        return result;
+    };
+    return S21MatrixAwaiter(job, std::move(token), std::move(progress));
+}
+
+S21MatrixAwaiter S21Matrix::inverse_async(std::stop_token token, S21Progress progress) const {
+    if (_rows != _cols) {
+        shape_error("matrix must be square");
+    }
+    auto job = [src = S21Matrix(*this)](std::stop_token stop, const S21Progress& report) {
+        double det = src.determinant();
+        if (src.comp_doubles(0.0, det)) {
+            throw ExceptionError("S21Matrix: matrix is singular");
+        }
+        S21Matrix result(src._rows, src._cols, S21Uninitialized{});
+        if (src._rows == 1) {
+            result._matrix[0][0] = 1 / det;
+        } else {
+            S21Matrix trans = src.transpose();
+            for (int i = 0; i < src._rows; i++) {
+                if (stop.stop_requested()) {
+                    throw ExceptionError("S21Matrix: operation cancelled");
+                }
+                trans.complements_rows(result, i, i + 1);
+                if (report) report(static_cast<double>(i + 1) / src._rows);
+            }
+            result.mul_number(1 / det);
+        }
+        if (src._rows == 1 && report) report(1.0);
+        return result;
+    };
+    return S21MatrixAwaiter(job, std::move(token), std::move(progress));
+}
@@ -0,0 +1,691 @@
+#include <algorithm>
+#include <cfloat>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+#include "s21_thread_pool.h"
+
+namespace {
+
+const int kMaxSweeps = 60;
+const int kMaxRefinements = 10;
+
+// Eigenvalues of the symmetric tridiagonal matrix (d, e) by implicit QL with
+// Wilkinson shifts; e[i] holds T(i + 1, i) and is destroyed. When z is not null
+// the rotations are accumulated into the columns of the n x n rows z. An e[m]
+// is dropped once it is negligible next to its diagonal or to ||T||: the sweeps
+// leave rounding noise of about DBL_EPSILON * ||T|| in a cluster of small values.
+void tridiagonal_ql(std::vector<double>& d, std::vector<double>& e, double** z) {
+    int n = static_cast<int>(d.size());
+    double tnorm = 0.0;
+    for (int i = 0; i < n; i++) tnorm = fmax(tnorm, fabs(d[i]) + fabs(e[i]) + (i > 0 ? fabs(e[i - 1]) : 0.0));
+    for (int l = 0; l < n; l++) {
+        int m = l;
+        for (int iter = 0;; iter++) {
+            for (m = l; m < n - 1; m++) {
+                double dd = fabs(d[m]) + fabs(d[m + 1]);
+                if (fabs(e[m]) <= DBL_EPSILON * fmax(dd, 4.0 * tnorm)) break;
+            }
+            if (m == l) break;
+            if (iter == kMaxSweeps) {
+                throw ExceptionError("S21Matrix: eigenvalue iteration did not converge");
+            }
+            double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+            double r = hypot(g, 1.0);
+            g = d[m] - d[l] + e[l] / (g + copysign(r, g));
+            double s = 1.0, c = 1.0, p = 0.0;
+            int i = m - 1;
+            for (; i >= l; i--) {
+                double f = s * e[i];
+                double b = c * e[i];
+                e[i + 1] = (r = hypot(f, g));
+                if (r == 0.0) {
+                    d[i + 1] -= p;
+                    e[m] = 0.0;
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = d[i + 1] - p;
+                r = (d[i] - g) * s + 2.0 * c * b;
+                d[i + 1] = g + (p = s * r);
+                g = c * r - b;
+                if (z != nullptr) {
+                    for (int k = 0; k < n; k++) {
+                        f = z[k][i + 1];
+                        z[k][i + 1] = s * z[k][i] + c * f;
+                        z[k][i] = c * z[k][i] - s * f;
+                    }
+                }
+            }
+            if (r == 0.0 && i >= l) continue;
+            d[l] -= p;
+            e[l] = g;
+            e[m] = 0.0;
+        }
+    }
+}
+
+// Solves (T - lambda I) y = x in place for the tridiagonal T = (d, e) using
+// Gaussian elimination with partial pivoting; tiny pivots are replaced by
+// eps * tnorm, which is what makes inverse iteration converge in one or two steps.
+void tridiagonal_shifted_solve(const std::vector<double>& d, const std::vector<double>& e, double lambda,
+                               double tnorm, std::vector<double>& x) {
+    int n = static_cast<int>(d.size());
+    double tiny = DBL_EPSILON * (tnorm > 0.0 ? tnorm : 1.0);
+    std::vector<double> u0(n), u1(n, 0.0), u2(n, 0.0), mult(n, 0.0);
+    std::vector<char> swapped(n, 0);
+    double diag = d[0] - lambda;
+    double sup = n > 1 ? e[0] : 0.0;
+    for (int i = 0; i < n - 1; i++) {
+        double sub = e[i];
+        double next_diag = d[i + 1] - lambda;
+        double next_sup = i + 1 < n - 1 ? e[i + 1] : 0.0;
+        if (fabs(diag) >= fabs(sub)) {
+            if (fabs(diag) < tiny) diag = tiny;
+            mult[i] = sub / diag;
+            u0[i] = diag;
+            u1[i] = sup;
+            diag = next_diag - mult[i] * sup;
+            sup = next_sup;
+        } else {
+            swapped[i] = 1;
+            mult[i] = diag / sub;
+            u0[i] = sub;
+            u1[i] = next_diag;
+            u2[i] = next_sup;
+            diag = sup - mult[i] * next_diag;
+            sup = -mult[i] * next_sup;
+        }
+    }
+    u0[n - 1] = fabs(diag) < tiny ? tiny : diag;
+    for (int i = 0; i < n - 1; i++) {
+        if (swapped[i]) std::swap(x[i], x[i + 1]);
+        x[i + 1] -= mult[i] * x[i];
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        double value = x[i];
+        if (i + 1 < n) value -= u1[i] * x[i + 1];
+        if (i + 2 < n) value -= u2[i] * x[i + 2];
+        x[i] = value / u0[i];
+    }
+}
+
+void normalize(std::vector<double>& x) {
+    double norm = 0.0;
+    for (double v : x) norm += v * v;
+    norm = sqrt(norm);
+    if (norm > 0.0) {
+        for (double& v : x) v /= norm;
+    }
+}
+
+// Applies the reflector H = I - tau v v^T kept in column j of a (v_j = 1 implied)
+// to columns [from, to) of x, both addressed from row j to rows - 1.
+void reflect(double** a, int rows, int j, double tau, double** x, int from, int to, std::vector<double>& w) {
+    if (tau == 0.0 || from >= to) return;
+    for (int c = from; c < to; c++) w[c] = x[j][c];
+    for (int i = j + 1; i < rows; i++) {
+        double vi = a[i][j];
+        const double* row = x[i];
+        for (int c = from; c < to; c++) w[c] += vi * row[c];
+    }
+    for (int c = from; c < to; c++) x[j][c] -= tau * w[c];
+    for (int i = j + 1; i < rows; i++) {
+        double vi = tau * a[i][j];
+        double* row = x[i];
+        for (int c = from; c < to; c++) row[c] -= vi * w[c];
+    }
+}
+
+// Householder QR of the rows x cols block a (rows >= cols) in place: R above the
+// diagonal, reflectors below it. The same reflections are applied to the p columns
+// of b, which then holds Q^T b. Rows are streamed in storage order.
+void householder_reduce(double** a, int rows, int cols, double** b, int p, double* tau) {
+    std::vector<double> w(cols > p ? cols : p);
+    for (int j = 0; j < cols; j++) {
+        double alpha = a[j][j];
+        double sigma = 0.0;
+        for (int i = j + 1; i < rows; i++) sigma += a[i][j] * a[i][j];
+        tau[j] = 0.0;
+        if (sigma == 0.0) continue;
+        double beta = -copysign(sqrt(alpha * alpha + sigma), alpha);
+        tau[j] = (beta - alpha) / beta;
+        double scale = 1.0 / (alpha - beta);
+        for (int i = j + 1; i < rows; i++) a[i][j] *= scale;
+        a[j][j] = beta;
+        reflect(a, rows, j, tau[j], a, j + 1, cols, w);
+        if (b != nullptr) reflect(a, rows, j, tau[j], b, 0, p, w);
+    }
+}
+
+// x <- Q x for the Q of householder_reduce; x has rows rows and p columns
+void householder_apply_q(double** a, const double* tau, int rows, int cols, double** x, int p) {
+    std::vector<double> w(p);
+    for (int j = cols - 1; j >= 0; j--) {
+        reflect(a, rows, j, tau[j], x, 0, p, w);
+    }
+}
+
+// In-place LU with partial pivoting of the n x n rows a; the row
+// updates below each pivot are split across the pool. Returns false when a
+// pivot is zero relative to the largest entry.
+template <typename T>
+bool lu_factor(T** a, int n, int* pivot) {
+    T largest = 0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) largest = fabs(a[i][j]) > largest ? fabs(a[i][j]) : largest;
+    }
+    T limit = largest * n * std::numeric_limits<T>::epsilon();
+    for (int j = 0; j < n; j++) {
+        int best = j;
+        for (int i = j + 1; i < n; i++) {
+            if (fabs(a[i][j]) > fabs(a[best][j])) best = i;
+        }
+        pivot[j] = best;
+        if (fabs(a[best][j]) <= limit) return false;
+        std::swap(a[best], a[j]);
+        const T* top = a[j];
+        int grain = S21ThreadPool::grain(n - j);
+        S21ThreadPool::instance().parallel_for(j + 1, n, grain, [&](int from, int to) {
+            for (int i = from; i < to; i++) {
+                T* row = a[i];
+                T factor = row[j] / top[j];
+                row[j] = factor;
+                for (int c = j + 1; c < n; c++) row[c] -= factor * top[c];
+            }
+        });
+    }
+    return true;
+}
+
+// Solves with the factors of lu_factor for the p columns of b in place. The row
+// pointers of lu were swapped, so pivot[] replays the same swaps on b.
+template <typename T>
+void lu_solve(T* const* lu, const int* pivot, int n, T** b, int p) {
+    for (int j = 0; j < n; j++) std::swap(b[j], b[pivot[j]]);
+    for (int i = 1; i < n; i++) {
+        for (int k = 0; k < i; k++) {
+            T factor = lu[i][k];
+            for (int c = 0; c < p; c++) b[i][c] -= factor * b[k][c];
+        }
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        for (int k = i + 1; k < n; k++) {
+            T factor = lu[i][k];
+            for (int c = 0; c < p; c++) b[i][c] -= factor * b[k][c];
+        }
+        for (int c = 0; c < p; c++) b[i][c] /= lu[i][i];
+    }
+}
+
+
+// One-sided Jacobi: rotates pairs of the n rows of w (length len) until they are
+// mutually orthogonal, applying the same rotations to the n rows of vt. The pairs
+// of a round-robin round are disjoint, so each round is split across the pool.
+void one_sided_jacobi(double** w, int n, int len, double** vt) {
+    int players = n + (n & 1);
+    std::vector<int> order(players);
+    std::iota(order.begin(), order.end(), 0);
+    for (int sweep = 0; sweep < kMaxSweeps; sweep++) {
+        std::atomic<bool> rotated{false};
+        for (int round = 0; round + 1 < players; round++) {
+            int grain = S21ThreadPool::grain(len + n);
+            S21ThreadPool::instance().parallel_for(0, players / 2, grain, [&](int from, int to) {
+                for (int i = from; i < to; i++) {
+                    int p = order[i], q = order[players - 1 - i];
+                    if (p >= n || q >= n) continue;
+                    double alpha = 0.0, beta = 0.0, gamma = 0.0;
+                    for (int c = 0; c < len; c++) {
+                        alpha += w[p][c] * w[p][c];
+                        beta += w[q][c] * w[q][c];
+                        gamma += w[p][c] * w[q][c];
+                    }
+                    if (fabs(gamma) <= DBL_EPSILON * sqrt(alpha) * sqrt(beta)) continue;
+                    rotated.store(true, std::memory_order_relaxed);
+                    double zeta = (beta - alpha) / (2.0 * gamma);
+                    double t = (zeta >= 0.0 ? 1.0 : -1.0) / (fabs(zeta) + hypot(1.0, zeta));
+                    double cs = 1.0 / hypot(1.0, t), sn = cs * t;
+                    for (int c = 0; c < len; c++) {
+                        double x = w[p][c], y = w[q][c];
+                        w[p][c] = cs * x - sn * y;
+                        w[q][c] = sn * x + cs * y;
+                    }
+                    for (int c = 0; c < n; c++) {
+                        double x = vt[p][c], y = vt[q][c];
+                        vt[p][c] = cs * x - sn * y;
+                        vt[q][c] = sn * x + cs * y;
+                    }
+                }
+            });
+            std::rotate(order.begin() + 1, order.end() - 1, order.end());
+        }
+        if (!rotated.load(std::memory_order_relaxed)) break;
+    }
+}
+
+// Removes the components along columns 0..c-1 of the orthonormal left (len rows)
+// from x, twice for stability, and returns the norm of what is left.
+double project_out(double** left, int len, int c, std::vector<double>& x) {
+    for (int pass = 0; pass < 2; pass++) {
+        for (int prev = 0; prev < c; prev++) {
+            double proj = 0.0;
+            for (int i = 0; i < len; i++) proj += x[i] * left[i][prev];
+            for (int i = 0; i < len; i++) x[i] -= proj * left[i][prev];
+        }
+    }
+    double norm = 0.0;
+    for (int i = 0; i < len; i++) norm = hypot(norm, x[i]);
+    return norm;
+}
+
+// A zero singular value leaves no direction: completes column c of left with the
+// unit vector that keeps the most after projecting out the previous columns.
+void complete_column(double** left, int len, int c, std::vector<double>& x) {
+    double best = -1.0;
+    for (int e = 0; e < len && best < 0.5; e++) {
+        std::fill(x.begin(), x.end(), 0.0);
+        x[e] = 1.0;
+        double norm = project_out(left, len, c, x);
+        if (norm > best) {
+            best = norm;
+            for (int i = 0; i < len; i++) left[i][c] = x[i] / norm;
+        }
+    }
+}
+
+}  // namespace
+
+S21Matrix S21Matrix::solve(const S21Matrix& b) const {
+    if (_rows != _cols || b._rows != _rows) {
+        shape_error("solve needs a square matrix and a right-hand side of matching rows", &b);
+    }
+    int n = _rows;
+    S21Matrix lu(*this), x(b);
+    lu.detach();
+    x.detach();
+    std::vector<int> pivot(n);
+    // the factorization permutes row pointers, so work on private copies of them
+    std::vector<double*> rows(lu._matrix, lu._matrix + n), rhs(x._matrix, x._matrix + n);
+    if (!lu_factor(rows.data(), n, pivot.data())) {
+        throw ExceptionError("S21Matrix: matrix is singular");
+    }
+    lu_solve(rows.data(), pivot.data(), n, rhs.data(), b._cols);
+    S21Matrix result(n, b._cols, S21Uninitialized{});
+    for (int i = 0; i < n; i++) {
+        std::copy(rhs[i], rhs[i] + b._cols, result._matrix[i]);
+    }
+    return result;
+}
+
+S21Matrix S21Matrix::solve_refined(const S21Matrix& b, S21RefineInfo* info) const {
+    if (_rows != _cols || b._rows != _rows) {
+        shape_error("solve needs a square matrix and a right-hand side of matching rows", &b);
+    }
+    int n = _rows, p = b._cols;
+    std::vector<float> lu(static_cast<long>(n) * n), work(static_cast<long>(n) * p);
+    std::vector<float*> rows(n), rhs(n);
+    for (int i = 0; i < n; i++) {
+        rows[i] = lu.data() + static_cast<long>(i) * n;
+        std::copy(_matrix[i], _matrix[i] + n, rows[i]);
+    }
+    std::vector<int> pivot(n);
+    bool factored = lu_factor(rows.data(), n, pivot.data());
+
+    S21Matrix x(n, p), r(n, p, S21Uninitialized{});
+    // x += (LU)^-1 r in float; returns the largest entry of the correction
+    auto correct = [&](const S21Matrix& residual) {
+        for (int i = 0; i < n; i++) {
+            rhs[i] = work.data() + static_cast<long>(i) * p;
+            std::copy(residual._matrix[i], residual._matrix[i] + p, rhs[i]);
+        }
+        lu_solve(rows.data(), pivot.data(), n, rhs.data(), p);
+        double step = 0.0;
+        for (int i = 0; i < n; i++) {
+            for (int c = 0; c < p; c++) {
+                x._matrix[i][c] += rhs[i][c];
+                step = fmax(step, fabs(rhs[i][c]));
+            }
+        }
+        return step;
+    };
+    // r = b - A x in double
+    auto update_residual = [&] {
+        int grain = S21ThreadPool::grain(n * p);
+        S21ThreadPool::instance().parallel_for(0, n, grain, [&](int from, int to) {
+            for (int i = from; i < to; i++) {
+                std::copy(b._matrix[i], b._matrix[i] + p, r._matrix[i]);
+                for (int k = 0; k < n; k++) {
+                    double aik = _matrix[i][k];
+                    for (int c = 0; c < p; c++) r._matrix[i][c] -= aik * x._matrix[k][c];
+                }
+            }
+        });
+    };
+
+    S21RefineInfo status;
+    bool converged = false;
+    if (factored) {
+        double previous = correct(b);
+        while (!converged && status.iterations < kMaxRefinements) {
+            update_residual();
+            double step = correct(r);
+            status.iterations++;
+            converged = step <= E * x.norm_inf();
+            // each step should shrink the error by about cond(A) * FLT_EPSILON
+            if (!converged && step > 0.5 * previous) break;
+            previous = step;
+        }
+    }
+    if (!converged) {
+        x = solve(b);
+        status.fallback = true;
+    }
+    update_residual();
+    status.residual = r.norm_inf() / (norm_inf() * x.norm_inf() + b.norm_inf());
+    if (info != nullptr) *info = status;
+    return x;
+}
+
+S21Matrix S21Matrix::tsqr(const S21Matrix& a, S21Matrix* rhs, S21Matrix* q) {
+    int m = a._rows, n = a._cols, p = rhs != nullptr ? rhs->_cols : 0;
+    S21ThreadPool& pool = S21ThreadPool::instance();
+    // independent row blocks of at least 2n rows, one per thread
+    int blocks = 1;
+    if (static_cast<long>(m) * n >= S21_PARALLEL_WORK) {
+        blocks = m / (2 * n);
+        if (blocks > pool.size() + 1) blocks = pool.size() + 1;
+        if (blocks < 1) blocks = 1;
+    }
+    auto first_row = [m, blocks](int b) { return static_cast<int>(static_cast<long>(m) * b / blocks); };
+    std::vector<S21Matrix> parts(blocks), rhs_parts(blocks);
+    std::vector<std::vector<double>> taus(blocks, std::vector<double>(n));
+    pool.parallel_for(0, blocks, 1, [&](int from, int to) {
+        for (int b = from; b < to; b++) {
+            int first = first_row(b);
+            int count = first_row(b + 1) - first;
+            parts[b] = S21Matrix(count, n, S21Uninitialized{});
+            for (int i = 0; i < count; i++) {
+                std::copy(a._matrix[first + i], a._matrix[first + i] + n, parts[b]._matrix[i]);
+            }
+            if (rhs != nullptr) {
+                rhs_parts[b] = S21Matrix(count, p, S21Uninitialized{});
+                for (int i = 0; i < count; i++) {
+                    std::copy(rhs->_matrix[first + i], rhs->_matrix[first + i] + p, rhs_parts[b]._matrix[i]);
+                }
+            }
+            householder_reduce(parts[b]._matrix, count, n, rhs != nullptr ? rhs_parts[b]._matrix : nullptr, p,
+                               taus[b].data());
+        }
+    });
+
+    // second level: QR of the stacked n x n triangles
+    S21Matrix top = parts[0], top_rhs = rhs_parts[0];
+    std::vector<double> top_tau = taus[0];
+    if (blocks > 1) {
+        top = S21Matrix(blocks * n, n);
+        top_rhs = S21Matrix(blocks * n, p > 0 ? p : 1);
+        for (int b = 0; b < blocks; b++) {
+            for (int i = 0; i < n; i++) {
+                for (int j = i; j < n; j++) top._matrix[b * n + i][j] = parts[b]._matrix[i][j];
+                for (int j = 0; j < p; j++) top_rhs._matrix[b * n + i][j] = rhs_parts[b]._matrix[i][j];
+            }
+        }
+        householder_reduce(top._matrix, blocks * n, n, rhs != nullptr ? top_rhs._matrix : nullptr, p,
+                           top_tau.data());
+    }
+
+    S21Matrix r(n, n);
+    for (int i = 0; i < n; i++) {
+        for (int j = i; j < n; j++) r._matrix[i][j] = top._matrix[i][j];
+    }
+    if (rhs != nullptr) {
+        S21Matrix c(n, p, S21Uninitialized{});
+        for (int i = 0; i < n; i++) {
+            std::copy(top_rhs._matrix[i], top_rhs._matrix[i] + p, c._matrix[i]);
+        }
+        *rhs = c;
+    }
+    if (q != nullptr) {
+        S21Matrix y(top._rows, n);
+        for (int i = 0; i < n; i++) y._matrix[i][i] = 1.0;
+        householder_apply_q(top._matrix, top_tau.data(), top._rows, n, y._matrix, n);
+        S21Matrix result = y;
+        if (blocks > 1) {
+            result = S21Matrix(m, n);
+            pool.parallel_for(0, blocks, 1, [&](int from, int to) {
+                for (int b = from; b < to; b++) {
+                    double** rows = result._matrix + first_row(b);
+                    for (int i = 0; i < n; i++) {
+                        std::copy(y._matrix[b * n + i], y._matrix[b * n + i] + n, rows[i]);
+                    }
+                    householder_apply_q(parts[b]._matrix, taus[b].data(), parts[b]._rows, n, rows, n);
+                }
+            });
+        }
+        *q = result;
+    }
+    return r;
+}
+
+S21Qr S21Matrix::qr() const {
+    if (_rows < _cols) {
+        shape_error("qr needs rows >= cols");
+    }
+    S21Qr result;
+    result.r = tsqr(*this, nullptr, &result.q);
+    return result;
+}
+
+S21Matrix S21Matrix::lstsq(const S21Matrix& b) const {
+    if (_rows < _cols || b._rows != _rows) {
+        shape_error("lstsq needs rows >= cols and a right-hand side with as many rows", &b);
+    }
+    S21Matrix c(b);
+    S21Matrix r = tsqr(*this, &c, nullptr);
+    int n = _cols;
+    double limit = 0.0;
+    for (int i = 0; i < n; i++) limit = fmax(limit, fabs(r._matrix[i][i]));
+    limit *= DBL_EPSILON * _rows;
+    for (int i = 0; i < n; i++) {
+        if (fabs(r._matrix[i][i]) <= limit) {
+            throw ExceptionError("S21Matrix: matrix is rank deficient");
+        }
+    }
+    S21Matrix x(n, b._cols, S21Uninitialized{});
+    for (int j = 0; j < b._cols; j++) {
+        for (int i = n - 1; i >= 0; i--) {
+            double value = c._matrix[i][j];
+            for (int k = i + 1; k < n; k++) value -= r._matrix[i][k] * x._matrix[k][j];
+            x._matrix[i][j] = value / r._matrix[i][i];
+        }
+    }
+    return x;
+}
+
+S21Eigen S21Matrix::eigen_symmetric(int k) const {
+    if (_rows != _cols) {
+        shape_error("matrix must be square");
+    }
+    int n = _rows;
+    if (k <= 0 || k > n) k = n;
+
+    // Householder tridiagonalization A = Q T Q^T, reading the lower triangle only.
+    // Reflector j acts on rows j + 1.. and is kept below the subdiagonal of a.
+    S21Matrix a(n, n, S21Uninitialized{});
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j <= i; j++) {
+            a._matrix[i][j] = a._matrix[j][i] = _matrix[i][j];
+        }
+    }
+    std::vector<double> d(n), e(n, 0.0), tau(n, 0.0), p(n), w(n);
+    S21ThreadPool& pool = S21ThreadPool::instance();
+    for (int j = 0; j + 2 < n; j++) {
+        double alpha = a._matrix[j + 1][j];
+        double sigma = 0.0;
+        for (int i = j + 2; i < n; i++) sigma += a._matrix[i][j] * a._matrix[i][j];
+        d[j] = a._matrix[j][j];
+        if (sigma == 0.0) {
+            e[j] = alpha;
+            continue;
+        }
+        double beta = -copysign(sqrt(alpha * alpha + sigma), alpha);
+        tau[j] = (beta - alpha) / beta;
+        for (int i = j + 2; i < n; i++) a._matrix[i][j] /= alpha - beta;
+        a._matrix[j + 1][j] = 1.0;
+        e[j] = beta;
+        auto v = [&a, j](int i) { return a._matrix[i][j]; };
+        int grain = S21ThreadPool::grain(n - j);
+        pool.parallel_for(j + 1, n, grain, [&](int from, int to) {
+            for (int r = from; r < to; r++) {
+                double acc = 0.0;
+                for (int c = j + 1; c < n; c++) acc += a._matrix[r][c] * v(c);
+                p[r] = tau[j] * acc;
+            }
+        });
+        double pv = 0.0;
+        for (int i = j + 1; i < n; i++) pv += p[i] * v(i);
+        for (int i = j + 1; i < n; i++) w[i] = p[i] - 0.5 * tau[j] * pv * v(i);
+        pool.parallel_for(j + 1, n, grain, [&](int from, int to) {
+            for (int r = from; r < to; r++) {
+                double vr = v(r), wr = w[r];
+                double* row = a._matrix[r];
+                for (int c = j + 1; c < n; c++) row[c] -= vr * w[c] + wr * v(c);
+            }
+        });
+    }
+    if (n >= 2) {
+        d[n - 2] = a._matrix[n - 2][n - 2];
+        e[n - 2] = a._matrix[n - 1][n - 2];
+    }
+    d[n - 1] = a._matrix[n - 1][n - 1];
+
+    std::vector<double> diag(d), offdiag(e);
+    double tnorm = 0.0;
+    for (int i = 0; i < n; i++) tnorm = fmax(tnorm, fabs(d[i]) + fabs(e[i]) + (i > 0 ? fabs(e[i - 1]) : 0.0));
+
+    // Few components: eigenvalues alone by QL (O(n^2)) and inverse iteration for
+    // the k wanted vectors. Otherwise accumulate the full set of rotations.
+    bool full = 4 * k >= n;
+    S21Matrix z(full ? n : 1, full ? n : 1);
+    if (full) {
+        for (int i = 0; i < n; i++) z._matrix[i][i] = 1.0;
+    }
+    tridiagonal_ql(d, e, full ? z._matrix : nullptr);
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&d](int x, int y) { return d[x] > d[y]; });
+
+    S21Eigen result{S21Matrix(k, 1, S21Uninitialized{}), S21Matrix(n, k, S21Uninitialized{})};
+    std::vector<std::vector<double>> vectors(k, std::vector<double>(n));
+    for (int c = 0; c < k; c++) {
+        result.values._matrix[c][0] = d[order[c]];
+        std::vector<double>& x = vectors[c];
+        if (full) {
+            for (int i = 0; i < n; i++) x[i] = z._matrix[i][order[c]];
+            continue;
+        }
+        for (int i = 0; i < n; i++) x[i] = 1.0 + 0.01 * ((i * 7919 + c * 104729) % 97);
+        for (int iter = 0; iter < 3; iter++) {
+            tridiagonal_shifted_solve(diag, offdiag, d[order[c]], tnorm, x);
+            for (int prev = 0; prev < c; prev++) {
+                double proj = 0.0;
+                for (int i = 0; i < n; i++) proj += x[i] * vectors[prev][i];
+                for (int i = 0; i < n; i++) x[i] -= proj * vectors[prev][i];
+            }
+            normalize(x);
+        }
+    }
+
+    // back-transformation x <- H_0 ... H_{n-3} x, one vector per task
+    pool.parallel_for(0, k, S21ThreadPool::grain(n * n), [&](int from, int to) {
+        for (int c = from; c < to; c++) {
+            std::vector<double>& x = vectors[c];
+            for (int j = n - 3; j >= 0; j--) {
+                if (tau[j] == 0.0) continue;
+                double dot = 0.0;
+                for (int i = j + 1; i < n; i++) dot += a._matrix[i][j] * x[i];
+                dot *= tau[j];
+                for (int i = j + 1; i < n; i++) x[i] -= dot * a._matrix[i][j];
+            }
+            for (int i = 0; i < n; i++) result.vectors._matrix[i][c] = x[i];
+        }
+    });
+    return result;
+}
+
+S21Svd S21Matrix::svd(int k, S21SvdMethod method) const {
+    int small = _rows < _cols ? _rows : _cols;
+    if (k <= 0 || k > small) k = small;
+    bool tall = _rows >= _cols;
+    S21Matrix a = tall ? *this : transpose();
+    int m = a._rows, n = a._cols;
+    S21Svd result{S21Matrix(), S21Matrix(k, 1, S21Uninitialized{}), S21Matrix()};
+    S21Matrix left;
+    std::vector<double> x;
+    if (method == S21SvdMethod::kGram) {
+        // A^T A = V diag(s^2) V^T: only its k largest eigenpairs are computed, and
+        // both products run on the GEMM kernel. u = A v is orthogonalized against the
+        // previous columns; below sqrt(DBL_EPSILON) * s_max it is noise and replaced.
+        S21Eigen eigen = (a.transpose() * a).eigen_symmetric(k);
+        result.v = eigen.vectors;
+        left = a * eigen.vectors;
+        x.resize(m);
+        double top = sqrt(fmax(eigen.values._matrix[0][0], 0.0));
+        for (int c = 0; c < k; c++) {
+            double sigma = sqrt(fmax(eigen.values._matrix[c][0], 0.0));
+            result.s._matrix[c][0] = sigma;
+            for (int i = 0; i < m; i++) x[i] = left._matrix[i][c];
+            double norm = project_out(left._matrix, m, c, x);
+            if (sigma > sqrt(DBL_EPSILON) * top && norm >= DBL_MIN) {
+                for (int i = 0; i < m; i++) left._matrix[i][c] = x[i] / norm;
+            } else {
+                complete_column(left._matrix, m, c, x);
+            }
+        }
+        result.u = left;
+        if (!tall) result.u.swap(result.v);
+        return result;
+    }
+
+    // a strictly tall input is reduced to its n x n R by TSQR first and Q is
+    // applied to the left vectors at the end
+    S21Qr qr;
+    if (m > n) qr = a.qr();
+    // rows of w are the columns of A (or R); rows of vt accumulate V^T
+    S21Matrix w = m > n ? qr.r.transpose() : a.transpose();
+    int len = w._cols;
+    S21Matrix vt(n, n);
+    for (int i = 0; i < n; i++) vt._matrix[i][i] = 1.0;
+    one_sided_jacobi(w._matrix, n, len, vt._matrix);
+
+    std::vector<double> sigma(n);
+    for (int j = 0; j < n; j++) {
+        double norm = 0.0;
+        for (int c = 0; c < len; c++) norm = hypot(norm, w._matrix[j][c]);
+        sigma[j] = norm;
+    }
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sigma](int x, int y) { return sigma[x] > sigma[y]; });
+
+    result.v = S21Matrix(n, k, S21Uninitialized{});
+    left = S21Matrix(len, k, S21Uninitialized{});
+    x.resize(len);
+    for (int c = 0; c < k; c++) {
+        int j = order[c];
+        result.s._matrix[c][0] = sigma[j];
+        for (int i = 0; i < n; i++) result.v._matrix[i][c] = vt._matrix[j][i];
+        if (sigma[j] >= DBL_MIN) {
+            for (int i = 0; i < len; i++) left._matrix[i][c] = w._matrix[j][i] / sigma[j];
+        } else {
+            complete_column(left._matrix, len, c, x);
+        }
+    }
+    if (m > n) left = qr.q * left;
+    result.u = left;
+    if (!tall) result.u.swap(result.v);
+    return result;
+}
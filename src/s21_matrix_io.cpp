@@ -0,0 +1,144 @@
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+#include "s21_thread_pool.h"
+
+namespace {
+
+const char* skip_blanks(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+// Fields are separated by the delimiter and/or blanks. Returns the number of fields read
+// (at most limit, written to out when it is not null) or -1 with *error set.
+int parse_line(const char* p, const char* end, char delimiter, double* out, int limit, const char** error) {
+    int count = 0;
+    p = skip_blanks(p, end);
+    while (p < end) {
+        double value = 0.0;
+        auto [next, ec] = std::from_chars(p, end, value);
+        if (ec != std::errc() || count == limit) {
+            *error = p;
+            return -1;
+        }
+        if (out != nullptr) out[count] = value;
+        count++;
+        p = skip_blanks(next, end);
+        if (p < end && *p == delimiter) {
+            p = skip_blanks(p + 1, end);
+            if (p == end) {
+                *error = p;
+                return -1;
+            }
+        } else if (p < end && p == next) {
+            *error = p;
+            return -1;
+        }
+    }
+    return count;
+}
+
+}  // namespace
+
+S21Matrix S21Matrix::from_csv(const std::string& path, S21CsvInfo* info, char delimiter) {
+    S21CsvInfo status;
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        if (info != nullptr) *info = status;
+        throw ExceptionError("S21Matrix: cannot open file for reading");
+    }
+    std::string text(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(text.data(), static_cast<std::streamsize>(text.size()));
+
+    std::vector<const char*> lines;
+    const char* data = text.data();
+    const char* end = data + text.size();
+    for (const char* p = data; p < end;) {
+        lines.push_back(p);
+        const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        p = eol == nullptr ? end : eol + 1;
+    }
+    lines.push_back(end);
+    auto line_end = [&lines](int i) {
+        const char* e = lines[i + 1];
+        if (e > lines[i] && e[-1] == '\n') e--;
+        if (e > lines[i] && e[-1] == '\r') e--;
+        return e;
+    };
+    auto is_blank = [&](int i) { return skip_blanks(lines[i], line_end(i)) == line_end(i); };
+    int rows = static_cast<int>(lines.size()) - 1;
+    while (rows > 0 && is_blank(rows - 1)) rows--;
+
+    const char* error = nullptr;
+    int error_line = 0;
+    int cols = rows > 0 ? parse_line(lines[0], line_end(0), delimiter, nullptr, -1, &error) : 0;
+    if (cols < 0) {
+        error_line = 1;
+    } else if (cols == 0) {
+        error = data;
+        error_line = 1;
+    }
+    status.rows = rows;
+    status.cols = cols;
+
+    S21Matrix result;
+    if (error == nullptr) {
+        result = S21Matrix(rows, cols, S21Uninitialized{});
+        std::mutex mutex;
+        int grain = S21ThreadPool::grain(cols * 8);
+        S21ThreadPool::instance().parallel_for(0, rows, grain, [&](int from, int to) {
+            for (int i = from; i < to; i++) {
+                const char* bad = nullptr;
+                int count = parse_line(lines[i], line_end(i), delimiter, result._matrix[i], cols, &bad);
+                if (count != cols) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (error_line == 0 || i + 1 < error_line) {
+                        error_line = i + 1;
+                        error = bad != nullptr ? bad : line_end(i);
+                    }
+                    break;
+                }
+            }
+        });
+    }
+    if (error != nullptr) {
+        status.line = error_line;
+        status.column = static_cast<int>(error - lines[error_line - 1]) + 1;
+    }
+    if (info != nullptr) *info = status;
+    if (error != nullptr) {
+        throw ExceptionError("S21Matrix: malformed CSV input at " + std::to_string(status.line) + ":" +
+                             std::to_string(status.column));
+    }
+    return result;
+}
+
+void S21Matrix::to_csv(const std::string& path, char delimiter) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        throw ExceptionError("S21Matrix: cannot open file for writing");
+    }
+    std::vector<char> buffer(1 << 20);
+    char* const limit = buffer.data() + buffer.size() - 64;
+    char* p = buffer.data();
+    for (int i = 0; i < _rows; i++) {
+        for (int j = 0; j < _cols; j++) {
+            p = std::to_chars(p, limit + 63, _matrix[i][j]).ptr;
+            *p++ = j + 1 < _cols ? delimiter : '\n';
+            if (p >= limit) {
+                file.write(buffer.data(), p - buffer.data());
+                p = buffer.data();
+            }
+        }
+    }
+    file.write(buffer.data(), p - buffer.data());
+    if (!file) {
+        throw ExceptionError("S21Matrix: write failed");
+    }
+}
@@ -1,5 +1,41 @@
 #include "s21_matrix_oop.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "s21_thread_pool.h"
+
+namespace {
+
+// mismatches are accumulated branch-free over a block so the inner loop vectorizes,
+// and the scan stops after the first block that contains one
+template <typename Mismatch>
+bool all_match(const double* a, const double* b, long count, Mismatch mismatch) {
+    const long block = 16;
+    long i = 0;
+    for (; i + block <= count; i += block) {
+        bool bad = false;
+        for (long k = i; k < i + block; k++) {
+            bad |= mismatch(a[k], b[k]);
+        }
+        if (bad) return false;
+    }
+    bool bad = false;
+    for (; i < count; i++) {
+        bad |= mismatch(a[i], b[i]);
+    }
+    return !bad;
+}
+
+// maps the bit pattern onto a monotonic integer scale, so ULP distance is a difference
+std::int64_t ordered_bits(double value) {
+    std::int64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits < 0 ? INT64_MIN - bits : bits;
+}
+
+}  // namespace
+
 // constructors
 S21Matrix::S21Matrix() : _rows(1), _cols(1) { init_matrix(); }
 S21Matrix::S21Matrix(int rows, int cols) {
@@ -12,34 +48,111 @@ S21Matrix::S21Matrix(int rows, int cols) {
     }
     init_matrix();
 }
-S21Matrix::S21Matrix(const S21Matrix& other) : _rows(other._rows), _cols(other._cols) { copy_matrix(other); }
-S21Matrix::S21Matrix(S21Matrix&& other) : _rows(other._rows), _cols(other._cols), _matrix(other._matrix) {
+S21Matrix::S21Matrix(int rows, int cols, S21Uninitialized) {
+    // the 1x1 fallback is zeroed: results shaped after an empty operand stay defined
+    bool empty = rows <= 0 || cols <= 0;
+    if (empty) {
+        _rows = 1;
+        _cols = 1;
+    } else {
+        _rows = rows;
+        _cols = cols;
+    }
+    init_matrix(empty);
+}
+S21Matrix::S21Matrix(const S21Matrix& other)
+    : _rows(other._rows),
+      _cols(other._cols),
+      _matrix(other._matrix),
+      _refs(other._refs),
+      _fingerprint(other._fingerprint.load(std::memory_order_relaxed)) {
+    if (_refs != nullptr) _refs->fetch_add(1, std::memory_order_relaxed);
+}
+S21Matrix::S21Matrix(S21Matrix&& other)
+    : _rows(other._rows),
+      _cols(other._cols),
+      _matrix(other._matrix),
+      _refs(other._refs),
+      _fingerprint(other._fingerprint.load(std::memory_order_relaxed)) {
     other._rows = 0;
     other._cols = 0;
     other._matrix = 0;
+    other._refs = 0;
 }
 S21Matrix::~S21Matrix() { clean_matrix(); }
 
 // main functions
-bool S21Matrix::eq_matrix(const S21Matrix& other) {
-    bool result = true;
+bool S21Matrix::eq_matrix(const S21Matrix& other) const { return eq_matrix(other, S21Compare::kAbsolute, E); }
+bool S21Matrix::eq_matrix(const S21Matrix& other, S21Compare mode, double tolerance) const {
     if (other._cols != _cols || other._rows != _rows) {
-        result = false;
+        return false;
+    }
+    long count = static_cast<long>(_rows) * _cols;
+    if (count == 0) {
+        return true;
+    }
+    const double* a = _matrix[0];
+    const double* b = other._matrix[0];
+    bool result = true;
+    if (mode == S21Compare::kAbsolute) {
+        result = all_match(a, b, count,
+                           [tolerance](double x, double y) { return !(fabs(x - y) <= tolerance); });
+    } else if (mode == S21Compare::kRelative) {
+        result = all_match(a, b, count, [tolerance](double x, double y) {
+            return !(fabs(x - y) <= tolerance * fmax(fabs(x), fabs(y)));
+        });
+    } else if (mode == S21Compare::kUlp) {
+        result = all_match(a, b, count, [tolerance](double x, double y) {
+            std::int64_t dx = ordered_bits(x), dy = ordered_bits(y);
+            std::uint64_t ux = static_cast<std::uint64_t>(dx), uy = static_cast<std::uint64_t>(dy);
+            std::uint64_t distance = dx > dy ? ux - uy : uy - ux;
+            return isnan(x) || isnan(y) || !(static_cast<double>(distance) <= tolerance);
+        });
     } else {
-        for (int i = 0; i < _rows && result; i++) {
-            for (int j = 0; j < _cols && result; j++) {
-                if (!comp_doubles(_matrix[i][j], other._matrix[i][j])) {
-                    result = false;
-                }
-            }
+        // the sums are taken over entries divided by the largest magnitude so they
+        // cannot overflow; a NaN or infinite entry makes them NaN and the test false
+        double scale = 0.0;
+        for (long i = 0; i < count; i++) scale = fmax(scale, fmax(fabs(a[i]), fabs(b[i])));
+        if (scale == 0.0) scale = 1.0;
+        double diff = 0.0, norm_a = 0.0, norm_b = 0.0;
+        for (long i = 0; i < count; i++) {
+            double x = a[i] / scale, y = b[i] / scale;
+            diff += (x - y) * (x - y);
+            norm_a += x * x;
+            norm_b += y * y;
         }
+        result = sqrt(diff) <= tolerance * sqrt(fmax(norm_a, norm_b));
     }
     return result;
 }
+std::uint64_t S21Matrix::fingerprint() const {
+    std::uint64_t hash = _fingerprint.load(std::memory_order_relaxed);
+    if (hash == 0) {
+        const std::uint64_t prime = 0x100000001b3ULL;
+        std::uint64_t lanes[4] = {0xcbf29ce484222325ULL ^ static_cast<std::uint64_t>(_rows),
+                                  0x84222325cbf29ce4ULL ^ static_cast<std::uint64_t>(_cols),
+                                  0x9e3779b97f4a7c15ULL, 0xbf58476d1ce4e5b9ULL};
+        const double* x = data();
+        long count = static_cast<long>(_rows) * _cols;
+        for (long i = 0; i < count; i++) {
+            std::uint64_t bits;
+            memcpy(&bits, &x[i], sizeof(bits));
+            lanes[i & 3] = (lanes[i & 3] ^ bits) * prime;
+        }
+        hash = lanes[0];
+        for (int k = 1; k < 4; k++) {
+            hash = (hash ^ (lanes[k] >> 29) ^ lanes[k]) * 0x94d049bb133111ebULL;
+        }
+        if (hash == 0) hash = 1;
+        _fingerprint.store(hash, std::memory_order_relaxed);
+    }
+    return hash;
+}
 void S21Matrix::sum_matrix(const S21Matrix& other) {
     if (_rows != other._rows || _cols != other._cols) {
-        throw ExceptionError();
+        shape_error("dimensions of the operands differ", &other);
     }
+    detach();
     for (int i = 0; i < _rows; i++) {
         for (int j = 0; j < _cols; j++) {
             _matrix[i][j] += other._matrix[i][j];
@@ -48,8 +161,9 @@ void S21Matrix::sum_matrix(const S21Matrix& other) {
 }
 void S21Matrix::sub_matrix(const S21Matrix& other) {
     if (_rows != other._rows || _cols != other._cols) {
-        throw ExceptionError();
+        shape_error("dimensions of the operands differ", &other);
     }
+    detach();
     for (int i = 0; i < _rows; i++) {
         for (int j = 0; j < _cols; j++) {
             _matrix[i][j] -= other._matrix[i][j];
@@ -57,6 +171,7 @@ void S21Matrix::sub_matrix(const S21Matrix& other) {
     }
 }
 void S21Matrix::mul_number(const double num) {
+    detach();
     for (int i = 0; i < _rows; i++) {
         for (int j = 0; j < _cols; j++) {
             _matrix[i][j] *= num;
@@ -65,50 +180,46 @@ void S21Matrix::mul_number(const double num) {
 }
 void S21Matrix::mul_matrix(const S21Matrix& other) {
     if (_cols != other._rows) {
-        throw ExceptionError();
+        shape_error("cols of the left operand must equal rows of the right one", &other);
     }
     S21Matrix temp(*this);
+    const S21Matrix& rhs = (&other == this) ? temp : other;
     clean_matrix();
-    _rows = temp._rows, _cols = other._cols;
-    init_matrix();
-    for (int i = 0; i < temp._rows; i++) {
-        for (int j = 0; j < other._cols; j++) {
-            for (int k = 0; k < temp._cols; k++) {
-                _matrix[i][j] += temp._matrix[i][k] * other._matrix[k][j];
-            }
-        }
-    }
+    _rows = temp._rows, _cols = rhs._cols;
+    init_matrix(false);
+    int grain = S21ThreadPool::grain(temp._cols * rhs._cols);
+    S21ThreadPool::instance().parallel_for(0, _rows, grain, [&](int from, int to) {
+        std::fill(_matrix[from], _matrix[from] + static_cast<long>(to - from) * _cols, 0.0);
+        mul_rows(temp, rhs, from, to);
+    });
 }
-S21Matrix S21Matrix::transpose() {
-    S21Matrix result(_cols, _rows);
-    for (int i = 0; i < _cols; i++) {
-        for (int j = 0; j < _rows; j++) {
-            result._matrix[i][j] = _matrix[j][i];
+S21Matrix S21Matrix::transpose() const {
+    S21Matrix result(_cols, _rows, S21Uninitialized{});
+    S21ThreadPool::instance().parallel_for(0, _cols, S21ThreadPool::grain(_rows), [&](int from, int to) {
+        for (int i = from; i < to; i++) {
+            for (int j = 0; j < _rows; j++) {
+                result._matrix[i][j] = _matrix[j][i];
+            }
         }
-    }
+    });
     return result;
 }
-S21Matrix S21Matrix::calc_complements() {
-    S21Matrix result(_rows, _cols);
+S21Matrix S21Matrix::calc_complements() const {
+    S21Matrix result(_rows, _cols, S21Uninitialized{});
     if (_rows != _cols) {
-        throw ExceptionError();
+        shape_error("matrix must be square");
     }
     if (_rows == 1) {
         result._matrix[0][0] = 1;
     } else {
-        for (int i = 0; i < _rows; i++) {
-            for (int j = 0; j < _cols; j++) {
-                S21Matrix temp = s21_get_minor_matrix(*this, i, j);
-                result._matrix[i][j] = temp.determinant() * pow(-1, (i + 1) + (j + 1));
-            }
-        }
+        complements_rows(result, 0, _rows);
     }
     return result;
 }
-double S21Matrix::determinant() {
+double S21Matrix::determinant() const {
     double result = 0.0;
     if (_rows != _cols) {
-        throw ExceptionError();
+        shape_error("matrix must be square");
     }
     if (_rows == 1) {
         result = _matrix[0][0];
@@ -116,42 +227,50 @@ double S21Matrix::determinant() {
         result = _matrix[0][0] * _matrix[1][1] - _matrix[0][1] * _matrix[1][0];
     } else {
         double det = 0.0;
+        S21Matrix temp = acquire_scratch(_rows - 1, _cols - 1);
         for (int i = 0; i < _cols; i++) {
-            S21Matrix temp = s21_get_minor_matrix(*this, 0, i);
-            double k = pow(-1, i + 2);
+            s21_get_minor_matrix(*this, 0, i, temp);
+            double k = ::pow(-1, i + 2);
             det += k * _matrix[0][i] * temp.determinant();
         }
+        release_scratch(std::move(temp));
         result = det;
     }
     return result;
 }
-S21Matrix S21Matrix::inverse_matrix() {
-    S21Matrix result(_rows, _cols);
+S21Matrix S21Matrix::inverse_matrix() const {
     if (_rows != _cols) {
-        throw ExceptionError();
+        shape_error("matrix must be square");
     }
     double det = determinant();
-    if (!comp_doubles(0.0, det)) {
-        if (_rows == 1) {
-            result._matrix[0][0] = 1 / det;
-        } else {
-            S21Matrix trans = transpose();
-            S21Matrix temp = trans.calc_complements();
-            temp.mul_number(1 / det);
-            result = temp;
-        }
-    } else {
-        throw ExceptionError();
+    if (comp_doubles(0.0, det)) {
+        throw ExceptionError("S21Matrix: matrix is singular");
     }
+    return inverse_from(det);
+}
+// adjugate / det for a square matrix whose non-zero determinant is already known
+S21Matrix S21Matrix::inverse_from(double det) const {
+    if (_rows == 1) {
+        S21Matrix result(1, 1, S21Uninitialized{});
+        result._matrix[0][0] = 1 / det;
+        return result;
+    }
+    S21Matrix result = transpose().calc_complements();
+    result.mul_number(1 / det);
     return result;
 }
 
 // operators
 S21Matrix& S21Matrix::operator=(const S21Matrix& other) {
-    clean_matrix();
-    _rows = other._rows;
-    _cols = other._cols;
-    copy_matrix(other);
+    if (this != &other) {
+        clean_matrix();
+        _rows = other._rows;
+        _cols = other._cols;
+        _matrix = other._matrix;
+        _refs = other._refs;
+        _fingerprint.store(other._fingerprint.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        if (_refs != nullptr) _refs->fetch_add(1, std::memory_order_relaxed);
+    }
     return *this;
 }
 S21Matrix& S21Matrix::operator+=(const S21Matrix& other) {
@@ -171,34 +290,90 @@ S21Matrix& S21Matrix::operator-=(const S21Matrix& other) {
     sub_matrix(other);
     return *this;
 }
-S21Matrix S21Matrix::operator+(const S21Matrix& other) {
+S21Matrix S21Matrix::operator+(const S21Matrix& other) const {
     S21Matrix result(*this);
     result.sum_matrix(other);
     return result;
 }
-S21Matrix S21Matrix::operator-(const S21Matrix& other) {
+S21Matrix S21Matrix::operator-(const S21Matrix& other) const {
     S21Matrix result(*this);
     result.sub_matrix(other);
     return result;
 }
-S21Matrix S21Matrix::operator*(const S21Matrix& other) {
+S21Matrix S21Matrix::operator*(const S21Matrix& other) const {
     S21Matrix result(*this);
     result.mul_matrix(other);
     return result;
 }
-S21Matrix S21Matrix::operator*(const double number) {
+S21Matrix S21Matrix::operator*(const double number) const {
     S21Matrix result(*this);
     result.mul_number(number);
     return result;
 }
-bool S21Matrix::operator==(const S21Matrix& other) { return eq_matrix(other); }
-double& S21Matrix::operator()(int row, int col) {
+bool S21Matrix::operator==(const S21Matrix& other) const { return eq_matrix(other); }
+double& S21Matrix::at(int row, int col) {
+    check_index(row, col);
+    detach();
+    return _matrix[row][col];
+}
+double S21Matrix::at(int row, int col) const {
+    check_index(row, col);
+    return _matrix[row][col];
+}
+double* S21Matrix::data() {
+    detach();
+    return _matrix == nullptr ? nullptr : _matrix[0];
+}
+const double* S21Matrix::data() const { return _matrix == nullptr ? nullptr : _matrix[0]; }
+
+// status-code variants
+S21Status S21Matrix::try_at(int row, int col, double& value) const noexcept {
     if (row < 0 || row >= _rows || col < 0 || col >= _cols) {
-        throw ExceptionError();
+        return S21Status::kOutOfRange;
     }
-    return _matrix[row][col];
+    value = _matrix[row][col];
+    return S21Status::kOk;
+}
+S21Status S21Matrix::try_sum_matrix(const S21Matrix& other) noexcept {
+    if (_rows != other._rows || _cols != other._cols) {
+        return S21Status::kDimensionMismatch;
+    }
+    sum_matrix(other);
+    return S21Status::kOk;
+}
+S21Status S21Matrix::try_sub_matrix(const S21Matrix& other) noexcept {
+    if (_rows != other._rows || _cols != other._cols) {
+        return S21Status::kDimensionMismatch;
+    }
+    sub_matrix(other);
+    return S21Status::kOk;
+}
+S21Status S21Matrix::try_mul_matrix(const S21Matrix& other) noexcept {
+    if (_cols != other._rows) {
+        return S21Status::kDimensionMismatch;
+    }
+    mul_matrix(other);
+    return S21Status::kOk;
+}
+S21Status S21Matrix::try_determinant(double& result) const noexcept {
+    if (_rows != _cols) {
+        return S21Status::kNotSquare;
+    }
+    result = determinant();
+    return S21Status::kOk;
+}
+S21Status S21Matrix::try_inverse_matrix(S21Matrix& result) const noexcept {
+    if (_rows != _cols) {
+        return S21Status::kNotSquare;
+    }
+    double det = determinant();
+    if (comp_doubles(0.0, det)) {
+        return S21Status::kSingular;
+    }
+    result = inverse_from(det);
+    return S21Status::kOk;
 }
-S21Matrix operator*(const double num, const S21Matrix& m) {
+S21Matrix S21_MATRIX_ABI::operator*(const double num, const S21Matrix& m) {
     S21Matrix result(m);
     result.mul_number(num);
     return result;
@@ -4,64 +4,343 @@
 #include <math.h>
 #include <stdio.h>
 
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <optional>
+#include <stop_token>
+#include <string>
 
 #define E 1e-6
+// operator() checks its indices unless this is 0; at() always does. The setting is
+// program-wide: it picks the inline namespace everything below is declared in, so a
+// translation unit built with another setting than the library fails to link
+#ifndef S21_MATRIX_BOUNDS_CHECK
+#ifdef NDEBUG
+#define S21_MATRIX_BOUNDS_CHECK 0
+#else
+#define S21_MATRIX_BOUNDS_CHECK 1
+#endif
+#endif
+#if S21_MATRIX_BOUNDS_CHECK
+#define S21_MATRIX_ABI s21_checked
+#else
+#define S21_MATRIX_ABI s21_unchecked
+#endif
+// how many released temporaries of one shape each thread keeps for reuse
+#define S21_SCRATCH_PER_SHAPE 4
+// storage of at least this many bytes is page aligned, and a zero fill below
+// S21_LAZY_ZERO_BYTES is done by the pool, spreading the first touch over its nodes;
+// uninitialized storage is first touched by whichever threads write the result
+#define S21_NUMA_MIN_BYTES (1 << 20)
+// zero-filled storage of at least this many bytes comes from calloc, whose fresh
+// pages the kernel zeroes lazily when they are first touched
+#define S21_LAZY_ZERO_BYTES (1 << 26)
 
-class ExceptionError {
+inline namespace S21_MATRIX_ABI {
+
+class S21MatrixAwaiter;
+class S21ElementRef;
+struct S21Eigen;
+struct S21Svd;
+struct S21Qr;
+using S21Progress = std::function<void(double)>;
+
+// tolerance semantics for eq_matrix: |a - b| <= tol, |a - b| <= tol * max(|a|, |b|),
+// at most tol representable doubles apart, or ||A - B||_F <= tol * max(||A||_F, ||B||_F);
+// a NaN entry never compares equal, not even to itself
+enum class S21Compare { kAbsolute, kRelative, kUlp, kNorm };
+// kJacobi resolves every singular value and costs a full decomposition whatever k is;
+// kGram computes only the k largest, from A^T A, so values below about
+// sqrt(DBL_EPSILON) * s_max are not resolved
+enum class S21SvdMethod { kJacobi, kGram };
+
+// scratch pool counters; hits and misses are process-wide, cached is for the calling thread
+struct S21ScratchStats {
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long cached;
+};
+
+// constructor tag: the elements are left unset for callers that overwrite all of them
+struct S21Uninitialized {};
+
+// outcome of S21Matrix::solve_refined: refinement steps taken, final normwise
+// backward error ||b - A x|| / (||A|| ||x|| + ||b||) and whether the double LU was used
+struct S21RefineInfo {
+    int iterations = 0;
+    double residual = 0.0;
+    bool fallback = false;
+};
+
+// dimensions detected by S21Matrix::from_csv and the 1-based position of the first error
+struct S21CsvInfo {
+    int rows = 0;
+    int cols = 0;
+    int line = 0;
+    int column = 0;
+};
+
+class ExceptionError : public std::exception {
  public:
     ExceptionError();
+    explicit ExceptionError(const std::string& message);
     ~ExceptionError();
+    const char* what() const noexcept override;
+
+ private:
+    std::string _message;
 };
 
+// results of the noexcept try_* members
+enum class S21Status { kOk, kOutOfRange, kDimensionMismatch, kNotSquare, kSingular };
+
+// Storage is reference counted and shared between copies; every mutating member
+// detaches (deep-copies) first, so copies are O(1) until one of them is written.
+//
+// Threading model: any number of threads may call const members on the same
+// matrix, and copy it, concurrently. A matrix (handle) that is being written
+// must not be accessed by other threads at the same time; copies taken from it
+// are independent handles and may be written from their own threads. Pointers
+// from data() and references from at() are invalidated by copying the matrix.
 class S21Matrix {
  private:
     int _rows, _cols;
     double** _matrix;
+    std::atomic<int>* _refs;
+    mutable std::atomic<std::uint64_t> _fingerprint{0};
 
-    void init_matrix();
-    bool comp_doubles(double, double);
-    S21Matrix s21_get_minor_matrix(const S21Matrix&, int, int);
+    void init_matrix(bool zero_fill = true);
+    void check_index(int row, int col) const;
+    [[noreturn, gnu::cold]] void index_error(int row, int col) const;
+    // throws "S21Matrix: <message> (RxC[ and RxC of other])"
+    [[noreturn, gnu::cold]] void shape_error(const char* message, const S21Matrix* other = nullptr) const;
+    void detach();
+    double& write_element(int row, int col);
+    void resize(int rows, int cols);
+    bool comp_doubles(double, double) const;
+    void s21_get_minor_matrix(const S21Matrix&, int, int, S21Matrix&) const;
     void copy_matrix(const S21Matrix&);
+    void mul_rows(const S21Matrix& a, const S21Matrix& b, int from, int to);
+    static void mul_into(const S21Matrix& a, const S21Matrix& b, S21Matrix& out);
+    void swap(S21Matrix& other) noexcept;
+    void complements_rows(S21Matrix& result, int from, int to) const;
+    S21Matrix inverse_from(double det) const;
+    // per-thread recycling of temporaries in the recursive cofactor algorithms; the
+    // elements of an acquired matrix are unset, whether it is recycled or new
+    static S21Matrix acquire_scratch(int rows, int cols);
+    static void release_scratch(S21Matrix&& scratch);
+    static S21Matrix tsqr(const S21Matrix& a, S21Matrix* rhs, S21Matrix* q);
+
+    friend class S21ElementRef;
 
  public:
     // double** _matrix;
 
     S21Matrix();
     S21Matrix(int rows, int cols);
+    S21Matrix(int rows, int cols, S21Uninitialized);
     S21Matrix(const S21Matrix& other);
     S21Matrix(S21Matrix&& other);
     ~S21Matrix();
 
-    int get_rows();
-    int get_cols();
+    int get_rows() const;
+    int get_cols() const;
     void set_rows(int rows);
     void set_cols(int cols);
     void clean_matrix();
 
-    bool eq_matrix(const S21Matrix& other);
+    bool eq_matrix(const S21Matrix& other) const;
+    bool eq_matrix(const S21Matrix& other, S21Compare mode, double tolerance) const;
+    // Content hash, cached until the next write through operator(), the mutating
+    // members, or a call to data() / non-const at(). Writes through a pointer or
+    // reference that was obtained before the hash was computed are not seen.
+    std::uint64_t fingerprint() const;
     void sum_matrix(const S21Matrix& other);
     void sub_matrix(const S21Matrix& other);
     void mul_number(const double num);
     void mul_matrix(const S21Matrix& other);
-    S21Matrix transpose();
-    S21Matrix calc_complements();
-    double determinant();
-    S21Matrix inverse_matrix();
+    S21Matrix transpose() const;
+    S21Matrix calc_complements() const;
+    double determinant() const;
+    S21Matrix inverse_matrix() const;
+
+    // awaitable variants, computed on S21ThreadPool; the caller is resumed on a pool thread
+    S21MatrixAwaiter mul_async(const S21Matrix& other, std::stop_token token = {},
+                               S21Progress progress = {}) const;
+    S21MatrixAwaiter inverse_async(std::stop_token token = {}, S21Progress progress = {}) const;
+
+    static S21ScratchStats scratch_stats();
+    // spread the pages of large matrices allocated from now on round-robin over all
+    // NUMA nodes; returns whether interleaving is in effect (never on a single node)
+    static bool set_numa_interleave(bool enable);
+
+    // reductions; sums are pairwise or Kahan-compensated, variances are population variances.
+    // An empty (moved-from) matrix sums to 0 and has NaN min() and max()
+    double sum() const;
+    double min() const;
+    double max() const;
+    double max_abs() const;
+    double trace() const;
+    double dot(const S21Matrix& other) const;
+    double norm_frobenius() const;
+    double norm_one() const;
+    double norm_inf() const;
+    S21Matrix row_sums() const;
+    S21Matrix col_sums() const;
+    S21Matrix col_means() const;
+    S21Matrix col_variances() const;
+
+    // A^k by repeated squaring and e^A by scaling and squaring with Pade approximants
+    S21Matrix pow(int k) const;
+    S21Matrix expm() const;
 
-    S21Matrix operator+(const S21Matrix& other);
+    // spectral decompositions; k limits the result to the k largest components.
+    // Householder tridiagonalization (level-2, rows split across the pool), then QL
+    // for every vector or, for k < n / 4, inverse iteration for the k wanted ones
+    S21Eigen eigen_symmetric(int k = 0) const;
+    // thin SVD; kJacobi runs one-sided Jacobi on A (after TSQR for tall input) with
+    // singular values accurate to about DBL_EPSILON * ||A||, kGram runs
+    // eigen_symmetric(k) on A^T A; u and v stay orthonormal for zero values
+    S21Svd svd(int k = 0, S21SvdMethod method = S21SvdMethod::kJacobi) const;
+    // solution of A x = b by LU with partial pivoting
+    S21Matrix solve(const S21Matrix& b) const;
+    // the same solution from a float LU refined with double residuals; falls back
+    // to solve() when refinement stalls
+    S21Matrix solve_refined(const S21Matrix& b, S21RefineInfo* info = nullptr) const;
+    // Householder QR for rows >= cols; tall inputs are factored as independent row
+    // blocks in parallel (TSQR) and the stacked triangles are reduced once more
+    S21Qr qr() const;
+    // x minimizing ||A x - b|| for every column of b, via QR
+    S21Matrix lstsq(const S21Matrix& b) const;
+
+    // delimiter and/or whitespace separated text, one matrix row per line
+    static S21Matrix from_csv(const std::string& path, S21CsvInfo* info = nullptr, char delimiter = ',');
+    void to_csv(const std::string& path, char delimiter = ',') const;
+
+    S21Matrix operator+(const S21Matrix& other) const;
     S21Matrix& operator+=(const S21Matrix& other);
-    S21Matrix operator-(const S21Matrix& other);
+    S21Matrix operator-(const S21Matrix& other) const;
     S21Matrix& operator-=(const S21Matrix& other);
-    S21Matrix operator*(const S21Matrix& other);
+    S21Matrix operator*(const S21Matrix& other) const;
     S21Matrix& operator*=(const S21Matrix& other);
-    S21Matrix operator*(const double number);
+    S21Matrix operator*(const double number) const;
     S21Matrix& operator*=(const double number);
     S21Matrix& operator=(const S21Matrix& other);
-    bool operator==(const S21Matrix& other);
-    double& operator()(int row, int col);
+    bool operator==(const S21Matrix& other) const;
+    // reads through the returned handle leave shared storage shared; only writes detach
+    S21ElementRef operator()(int row, int col);
+    double operator()(int row, int col) const;
+    double& at(int row, int col);
+    double at(int row, int col) const;
+    // contiguous row-major elements; the non-const overload detaches shared storage first
+    double* data();
+    const double* data() const;
+
+    // report errors instead of throwing; allocation failure still terminates
+    S21Status try_at(int row, int col, double& value) const noexcept;
+    S21Status try_sum_matrix(const S21Matrix& other) noexcept;
+    S21Status try_sub_matrix(const S21Matrix& other) noexcept;
+    S21Status try_mul_matrix(const S21Matrix& other) noexcept;
+    S21Status try_determinant(double& result) const noexcept;
+    S21Status try_inverse_matrix(S21Matrix& result) const noexcept;
 };
 
 S21Matrix operator*(const double num, const S21Matrix& m);
 
+inline void S21Matrix::check_index(int row, int col) const {
+    if (row < 0 || row >= _rows || col < 0 || col >= _cols) [[unlikely]] {
+        index_error(row, col);
+    }
+}
+
+// sole owners only drop a cached fingerprint; shared storage is copied first
+inline double& S21Matrix::write_element(int row, int col) {
+    if (_refs->load(std::memory_order_acquire) > 1) {
+        detach();
+    } else if (_fingerprint.load(std::memory_order_relaxed) != 0) {
+        _fingerprint.store(0, std::memory_order_relaxed);
+    }
+    return _matrix[row][col];
+}
+
+// One element of a non-const matrix. Converts to its current value; assigning
+// to it detaches the matrix from shared storage first.
+class S21ElementRef {
+ public:
+    operator double() const { return _owner._matrix[_row][_col]; }
+    S21ElementRef& operator=(double value) {
+        _owner.write_element(_row, _col) = value;
+        return *this;
+    }
+    S21ElementRef& operator=(const S21ElementRef& other) { return *this = static_cast<double>(other); }
+    S21ElementRef& operator+=(double value) { return *this = *this + value; }
+    S21ElementRef& operator-=(double value) { return *this = *this - value; }
+    S21ElementRef& operator*=(double value) { return *this = *this * value; }
+    S21ElementRef& operator/=(double value) { return *this = *this / value; }
+
+ private:
+    friend class S21Matrix;
+    S21ElementRef(S21Matrix& owner, int row, int col) : _owner(owner), _row(row), _col(col) {}
+
+    S21Matrix& _owner;
+    int _row, _col;
+};
+
+inline S21ElementRef S21Matrix::operator()(int row, int col) {
+#if S21_MATRIX_BOUNDS_CHECK
+    check_index(row, col);
+#endif
+    return S21ElementRef(*this, row, col);
+}
+
+inline double S21Matrix::operator()(int row, int col) const {
+#if S21_MATRIX_BOUNDS_CHECK
+    check_index(row, col);
+#endif
+    return _matrix[row][col];
+}
+
+// eigenvalues in descending order as a k x 1 column, orthonormal eigenvectors as columns
+struct S21Eigen {
+    S21Matrix values;
+    S21Matrix vectors;
+};
+
+// thin SVD A = u * diag(s) * v^T with singular values in descending order
+struct S21Svd {
+    S21Matrix u;
+    S21Matrix s;
+    S21Matrix v;
+};
+
+// thin QR: q is rows x cols with orthonormal columns, r is cols x cols upper triangular
+struct S21Qr {
+    S21Matrix q;
+    S21Matrix r;
+};
+
+class S21MatrixAwaiter {
+ public:
+    using Job = std::function<S21Matrix(std::stop_token, const S21Progress&)>;
+
+    S21MatrixAwaiter(Job job, std::stop_token token, S21Progress progress);
+
+    bool await_ready() const noexcept;
+    void await_suspend(std::coroutine_handle<> caller);
+    S21Matrix await_resume();
+
+ private:
+    Job _job;
+    std::stop_token _token;
+    S21Progress _progress;
+    std::optional<S21Matrix> _result;
+    std::exception_ptr _error;
+};
+
+}  // namespace S21_MATRIX_ABI
+
 #endif  // SRC_S21_MATRIX_OOP_H_
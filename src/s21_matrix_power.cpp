@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+
+#include "s21_matrix_oop.h"
+
+namespace {
+
+// Pade degrees and the 1-norm bounds below which each one reaches double
+// precision (Higham, "The scaling and squaring method for the matrix exponential
+// revisited", 2005)
+const int kDegrees[] = {3, 5, 7, 9};
+const double kTheta[] = {1.495585217958292e-2, 2.539398330063230e-1, 9.504178996162932e-1,
+                         2.097847961257068e0};
+const double kTheta13 = 5.371920351148152e0;
+const double kPade[4][10] = {
+    {120.0, 60.0, 12.0, 1.0},
+    {30240.0, 15120.0, 3360.0, 420.0, 30.0, 1.0},
+    {17297280.0, 8648640.0, 1995840.0, 277200.0, 25200.0, 1512.0, 56.0, 1.0},
+    {17643225600.0, 8821612800.0, 2075673600.0, 302702400.0, 30270240.0, 2162160.0, 110880.0, 3960.0, 90.0,
+     1.0}};
+const double kPade13[] = {64764752532480000.0,
+                          32382376266240000.0,
+                          7771770303897600.0,
+                          1187353796428800.0,
+                          129060195264000.0,
+                          10559470521600.0,
+                          670442572800.0,
+                          33522128640.0,
+                          1323241920.0,
+                          40840800.0,
+                          960960.0,
+                          16380.0,
+                          182.0,
+                          1.0};
+
+}  // namespace
+
+S21Matrix S21Matrix::pow(int k) const {
+    if (_rows != _cols || k < 0) {
+        shape_error("pow needs a square matrix and k >= 0");
+    }
+    S21Matrix result(_rows, _cols);
+    for (int i = 0; i < _rows; i++) {
+        result._matrix[i][i] = 1.0;
+    }
+    // the identity factor is never multiplied: the first odd bit just takes base
+    bool identity = true;
+    S21Matrix base(*this);
+    S21Matrix scratch(_rows, _cols, S21Uninitialized{}), squared(_rows, _cols, S21Uninitialized{});
+    long count = static_cast<long>(_rows) * _cols;
+    while (k > 0) {
+        if (k & 1) {
+            // copied rather than shared, so no buffer is ever detached
+            if (identity) {
+                std::copy(base._matrix[0], base._matrix[0] + count, scratch._matrix[0]);
+                identity = false;
+            } else {
+                mul_into(result, base, scratch);
+            }
+            result.swap(scratch);
+        }
+        k >>= 1;
+        if (k > 0) {
+            mul_into(base, base, squared);
+            base.swap(squared);
+        }
+    }
+    return result;
+}
+
+S21Matrix S21Matrix::expm() const {
+    if (_rows != _cols) {
+        shape_error("matrix must be square");
+    }
+    int n = _rows;
+    // out = c0 I + sum c_k M_k, accumulated in place over the contiguous storage;
+    // out may itself be a term, but only the first one
+    using Terms = std::initializer_list<std::pair<double, const S21Matrix*>>;
+    auto combine = [n](S21Matrix& out, double c0, Terms terms) {
+        out.detach();
+        double* dst = out._matrix[0];
+        long count = static_cast<long>(n) * n;
+        if (terms.size() == 0) std::fill(dst, dst + count, 0.0);
+        for (const auto& term : terms) {
+            const double* src = term.second->_matrix[0];
+            double c = term.first;
+            if (&term != terms.begin()) {
+                for (long i = 0; i < count; i++) dst[i] += c * src[i];
+            } else if (src != dst) {
+                for (long i = 0; i < count; i++) dst[i] = c * src[i];
+            } else if (c != 1.0) {
+                for (long i = 0; i < count; i++) dst[i] *= c;
+            }
+        }
+        for (int i = 0; i < n; i++) out._matrix[i][i] += c0;
+    };
+
+    double norm = norm_one();
+    // every buffer below is fully written by mul_into or combine
+    S21Uninitialized unset;
+    S21Matrix a(*this), a2(n, n, unset), a4(n, n, unset), a6(n, n, unset), a8(n, n, unset);
+    S21Matrix t(n, n, unset), u(n, n, unset), v(n, n, unset);
+    int squarings = 0;
+    int m = 0;
+    while (m < 4 && norm > kTheta[m]) m++;
+    if (m == 4) {
+        if (norm > kTheta13) {
+            squarings = static_cast<int>(ceil(log2(norm / kTheta13)));
+            a.mul_number(ldexp(1.0, -squarings));
+        }
+        const double* b = kPade13;
+        mul_into(a, a, a2);
+        mul_into(a2, a2, a4);
+        mul_into(a4, a2, a6);
+        combine(u, 0.0, {{b[13], &a6}, {b[11], &a4}, {b[9], &a2}});
+        mul_into(a6, u, t);
+        combine(u, b[1], {{1.0, &t}, {b[7], &a6}, {b[5], &a4}, {b[3], &a2}});
+        mul_into(a, u, t);
+        u.swap(t);
+        combine(v, 0.0, {{b[12], &a6}, {b[10], &a4}, {b[8], &a2}});
+        mul_into(a6, v, t);
+        combine(v, b[0], {{1.0, &t}, {b[6], &a6}, {b[4], &a4}, {b[2], &a2}});
+    } else {
+        const double* b = kPade[m];
+        int degree = kDegrees[m];
+        mul_into(a, a, a2);
+        if (degree >= 5) mul_into(a2, a2, a4);
+        if (degree >= 7) mul_into(a4, a2, a6);
+        if (degree >= 9) mul_into(a6, a2, a8);
+        const S21Matrix* powers[] = {&a2, &a4, &a6, &a8};
+        combine(t, b[1], {});
+        combine(v, b[0], {});
+        for (int k = 1; 2 * k <= degree; k++) {
+            combine(t, 0.0, {{1.0, &t}, {b[2 * k + 1], powers[k - 1]}});
+            combine(v, 0.0, {{1.0, &v}, {b[2 * k], powers[k - 1]}});
+        }
+        mul_into(a, t, u);
+    }
+    // r = (V - U)^-1 (V + U), then undo the scaling by repeated squaring
+    S21Matrix p(n, n, unset), q(n, n, unset);
+    combine(p, 0.0, {{1.0, &v}, {1.0, &u}});
+    combine(q, 0.0, {{1.0, &v}, {-1.0, &u}});
+    S21Matrix r = q.solve(p);
+    for (int i = 0; i < squarings; i++) {
+        mul_into(r, r, t);
+        r.swap(t);
+    }
+    return r;
+}
@@ -0,0 +1,205 @@
+#include <vector>
+
+#include "s21_matrix_oop.h"
+#include "s21_thread_pool.h"
+
+namespace {
+
+const long kBlock = 4096;
+
+// Pairwise summation: O(log n) error growth, with four independent
+// accumulators in the leaves so the compiler can vectorize them.
+template <typename F>
+double pairwise(const double* x, long n, F f) {
+    if (n <= 128) {
+        double acc[4] = {0.0, 0.0, 0.0, 0.0};
+        long i = 0;
+        for (; i + 4 <= n; i += 4) {
+            for (int k = 0; k < 4; k++) acc[k] += f(x[i + k]);
+        }
+        for (; i < n; i++) acc[0] += f(x[i]);
+        return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    }
+    long half = n / 2;
+    return pairwise(x, half, f) + pairwise(x + half, n - half, f);
+}
+
+// Runs leaf(begin, count) over fixed-size blocks in parallel. Block boundaries do
+// not depend on the number of threads, so results are reproducible.
+template <typename Leaf>
+std::vector<double> block_partials(long n, Leaf leaf) {
+    long blocks = (n + kBlock - 1) / kBlock;
+    std::vector<double> partial(blocks);
+    S21ThreadPool::instance().parallel_for(0, static_cast<int>(blocks), S21ThreadPool::grain(kBlock),
+                                           [&](int from, int to) {
+                                               for (long b = from; b < to; b++) {
+                                                   long begin = b * kBlock;
+                                                   long count = n - begin < kBlock ? n - begin : kBlock;
+                                                   partial[b] = leaf(begin, count);
+                                               }
+                                           });
+    return partial;
+}
+
+template <typename F>
+double sum_of(const double* x, long n, F f) {
+    if (n <= kBlock) return pairwise(x, n, f);
+    std::vector<double> partial =
+        block_partials(n, [x, f](long begin, long count) { return pairwise(x + begin, count, f); });
+    return pairwise(partial.data(), static_cast<long>(partial.size()), [](double v) { return v; });
+}
+
+// empty is returned for n == 0
+template <typename Pick>
+double fold_of(const double* x, long n, double empty, Pick pick) {
+    if (n == 0) return empty;
+    std::vector<double> partial = block_partials(n, [x, pick](long begin, long count) {
+        double result = pick(x[begin], x[begin]);
+        for (long i = begin + 1; i < begin + count; i++) result = pick(result, x[i]);
+        return result;
+    });
+    double result = partial[0];
+    for (double v : partial) result = pick(result, v);
+    return result;
+}
+
+// Kahan-compensated column sums of f(x); rows are streamed in storage order and
+// column ranges are split across threads.
+template <typename F>
+std::vector<double> column_sums(const double* x, int rows, int cols, F f) {
+    std::vector<double> sum(cols, 0.0);
+    std::vector<double> carry(cols, 0.0);
+    S21ThreadPool::instance().parallel_for(0, cols, S21ThreadPool::grain(rows), [&](int from, int to) {
+        for (long i = 0; i < rows; i++) {
+            const double* row = x + i * cols;
+            for (int j = from; j < to; j++) {
+                double y = f(row[j], j) - carry[j];
+                double t = sum[j] + y;
+                carry[j] = (t - sum[j]) - y;
+                sum[j] = t;
+            }
+        }
+    });
+    return sum;
+}
+
+}  // namespace
+
+double S21Matrix::sum() const {
+    return sum_of(data(), static_cast<long>(_rows) * _cols, [](double v) { return v; });
+}
+
+double S21Matrix::min() const {
+    return fold_of(data(), static_cast<long>(_rows) * _cols, NAN,
+                   [](double a, double b) { return b < a ? b : a; });
+}
+
+double S21Matrix::max() const {
+    return fold_of(data(), static_cast<long>(_rows) * _cols, NAN,
+                   [](double a, double b) { return b > a ? b : a; });
+}
+
+double S21Matrix::max_abs() const {
+    return fold_of(data(), static_cast<long>(_rows) * _cols, 0.0,
+                   [](double a, double b) { return fabs(b) > fabs(a) ? fabs(b) : fabs(a); });
+}
+
+double S21Matrix::trace() const {
+    if (_rows != _cols) {
+        shape_error("matrix must be square");
+    }
+    std::vector<double> diagonal(_rows);
+    for (int i = 0; i < _rows; i++) {
+        diagonal[i] = _matrix[i][i];
+    }
+    return pairwise(diagonal.data(), _rows, [](double v) { return v; });
+}
+
+double S21Matrix::dot(const S21Matrix& other) const {
+    if (_rows != other._rows || _cols != other._cols) {
+        shape_error("dimensions of the operands differ", &other);
+    }
+    const double* a = data();
+    const double* b = other.data();
+    long n = static_cast<long>(_rows) * _cols;
+    auto leaf = [a, b](long begin, long count) {
+        double acc[4] = {0.0, 0.0, 0.0, 0.0};
+        long i = begin;
+        for (; i + 4 <= begin + count; i += 4) {
+            for (int k = 0; k < 4; k++) acc[k] += a[i + k] * b[i + k];
+        }
+        for (; i < begin + count; i++) acc[0] += a[i] * b[i];
+        return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    };
+    std::vector<double> partial = block_partials(n, leaf);
+    return pairwise(partial.data(), static_cast<long>(partial.size()), [](double v) { return v; });
+}
+
+double S21Matrix::norm_frobenius() const {
+    double scale = max_abs();
+    double result = scale;
+    if (scale != 0.0 && !isinf(scale)) {
+        double squares = sum_of(data(), static_cast<long>(_rows) * _cols, [scale](double v) {
+            double r = v / scale;
+            return r * r;
+        });
+        result = scale * sqrt(squares);
+    }
+    return result;
+}
+
+double S21Matrix::norm_one() const {
+    std::vector<double> sums = column_sums(data(), _rows, _cols, [](double v, int) { return fabs(v); });
+    double result = 0.0;
+    for (double v : sums) result = v > result ? v : result;
+    return result;
+}
+
+double S21Matrix::norm_inf() const {
+    std::vector<double> sums(_rows);
+    S21ThreadPool::instance().parallel_for(0, _rows, S21ThreadPool::grain(_cols), [&](int from, int to) {
+        for (int i = from; i < to; i++) {
+            sums[i] = pairwise(_matrix[i], _cols, [](double v) { return fabs(v); });
+        }
+    });
+    return fold_of(sums.data(), _rows, 0.0, [](double a, double b) { return b > a ? b : a; });
+}
+
+S21Matrix S21Matrix::row_sums() const {
+    S21Matrix result(_rows, 1, S21Uninitialized{});
+    S21ThreadPool::instance().parallel_for(0, _rows, S21ThreadPool::grain(_cols), [&](int from, int to) {
+        for (int i = from; i < to; i++) {
+            result._matrix[i][0] = pairwise(_matrix[i], _cols, [](double v) { return v; });
+        }
+    });
+    return result;
+}
+
+S21Matrix S21Matrix::col_sums() const {
+    std::vector<double> sums = column_sums(data(), _rows, _cols, [](double v, int) { return v; });
+    S21Matrix result(1, _cols, S21Uninitialized{});
+    for (int j = 0; j < _cols; j++) {
+        result._matrix[0][j] = sums[j];
+    }
+    return result;
+}
+
+S21Matrix S21Matrix::col_means() const {
+    S21Matrix result = col_sums();
+    result.mul_number(1.0 / _rows);
+    return result;
+}
+
+S21Matrix S21Matrix::col_variances() const {
+    S21Matrix means = col_means();
+    const double* mean = means._matrix[0];
+    std::vector<double> squares = column_sums(data(), _rows, _cols, [mean](double v, int j) {
+        double d = v - mean[j];
+        return d * d;
+    });
+    S21Matrix result(1, _cols, S21Uninitialized{});
+    for (int j = 0; j < _cols; j++) {
+        result._matrix[0][j] = squares[j] / _rows;
+    }
+    return result;
+}
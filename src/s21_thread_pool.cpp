@@ -0,0 +1,187 @@
+#include "s21_thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+std::vector<int> parse_cpu_list(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream list(text);
+    std::string range;
+    while (std::getline(list, range, ',')) {
+        int first = 0, last = 0;
+        char dash = 0;
+        std::stringstream item(range);
+        if (!(item >> first)) continue;
+        last = first;
+        if (item >> dash && dash == '-' && !(item >> last)) last = first;
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+void pin_to_cpus(std::thread& worker, const std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    // placement is only a hint; an unpinned worker still does correct work
+    if (CPU_COUNT(&set) > 0) pthread_setaffinity_np(worker.native_handle(), sizeof(set), &set);
+#else
+    (void)worker;
+    (void)cpus;
+#endif
+}
+
+}  // namespace
+
+S21ThreadPool::S21ThreadPool(int threads) : _stop(false), _nodes(1) {
+    if (threads < 1) threads = 1;
+    std::vector<std::vector<int>> topology = numa_topology();
+    std::vector<std::vector<int>> nodes;
+    for (auto& cpus : topology) {
+        if (!cpus.empty()) nodes.push_back(std::move(cpus));
+    }
+    for (int i = 0; i < threads; i++) {
+        _workers.emplace_back([this] { worker_loop(); });
+        if (nodes.size() > 1) pin_to_cpus(_workers.back(), nodes[i % nodes.size()]);
+    }
+    if (nodes.size() > 1) _nodes = static_cast<int>(nodes.size());
+}
+
+S21ThreadPool::~S21ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _cv.notify_all();
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+S21ThreadPool& S21ThreadPool::instance() {
+    static S21ThreadPool pool([] {
+        const char* value = std::getenv("S21_THREADS");
+        int threads = value != nullptr ? std::atoi(value) : 0;
+        return threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+    }());
+    return pool;
+}
+
+int S21ThreadPool::size() const { return static_cast<int>(_workers.size()); }
+
+int S21ThreadPool::numa_nodes() const { return _nodes; }
+
+std::vector<std::vector<int>> S21ThreadPool::numa_topology(const std::string& root) {
+    std::vector<std::vector<int>> topology;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(root, error)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+            !std::all_of(name.begin() + 4, name.end(), [](unsigned char c) { return std::isdigit(c); })) {
+            continue;
+        }
+        std::size_t id = std::stoul(name.substr(4));
+        if (topology.size() <= id) topology.resize(id + 1);
+        std::ifstream file(entry.path() / "cpulist");
+        std::string text;
+        std::getline(file, text);
+        topology[id] = parse_cpu_list(text);
+    }
+    if (topology.empty()) topology.resize(1);
+    return topology;
+}
+
+void S21ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push_back(std::move(task));
+    }
+    _cv.notify_one();
+}
+
+void S21ThreadPool::worker_loop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [this] { return _stop || !_tasks.empty(); });
+            if (_tasks.empty()) return;
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+        task();
+    }
+}
+
+namespace {
+
+struct ParallelForState {
+    std::atomic<int> next{0};
+    int chunks = 0;
+    int done = 0;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::exception_ptr error;
+};
+
+// Claims chunks until none are left; the body is only touched for claimed chunks,
+// which the caller waits for, so late helpers never see a dangling reference.
+void run_chunks(const std::shared_ptr<ParallelForState>& state, int begin, int end, int chunk,
+                const std::function<void(int, int)>& body) {
+    for (int c = state->next.fetch_add(1); c < state->chunks; c = state->next.fetch_add(1)) {
+        int from = begin + c * chunk;
+        int to = from + chunk < end ? from + chunk : end;
+        std::exception_ptr error;
+        try {
+            body(from, to);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (error && !state->error) state->error = error;
+        if (++state->done == state->chunks) state->cv.notify_all();
+    }
+}
+
+}  // namespace
+
+void S21ThreadPool::parallel_for(int begin, int end, int grain, const std::function<void(int, int)>& body) {
+    int count = end - begin;
+    if (count <= 0) return;
+    if (grain < 1) grain = 1;
+    int max_chunks = size() + 1;
+    int chunks = (count + grain - 1) / grain;
+    if (chunks > max_chunks) chunks = max_chunks;
+    if (chunks <= 1) {
+        body(begin, end);
+        return;
+    }
+    int chunk = (count + chunks - 1) / chunks;
+    auto state = std::make_shared<ParallelForState>();
+    state->chunks = (count + chunk - 1) / chunk;
+    for (int i = 1; i < state->chunks; i++) {
+        submit([state, begin, end, chunk, &body] { run_chunks(state, begin, end, chunk, body); });
+    }
+    run_chunks(state, begin, end, chunk, body);
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&state] { return state->done == state->chunks; });
+    if (state->error) std::rethrow_exception(state->error);
+}
@@ -0,0 +1,53 @@
+#ifndef SRC_S21_THREAD_POOL_H_
+#define SRC_S21_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// approximate number of element operations worth handing to another thread
+#define S21_PARALLEL_WORK (1 << 16)
+
+// Process-wide worker pool shared by the parallel kernels and the async API.
+class S21ThreadPool {
+ private:
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void()>> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _stop;
+    int _nodes;
+
+    void worker_loop();
+
+ public:
+    explicit S21ThreadPool(int threads);
+    S21ThreadPool(const S21ThreadPool& other) = delete;
+    S21ThreadPool& operator=(const S21ThreadPool& other) = delete;
+    ~S21ThreadPool();
+
+    // S21_THREADS in the environment, read once, overrides the hardware thread count
+    static S21ThreadPool& instance();
+
+    int size() const;
+    // parallel_for grain for items of about work element operations each; an
+    // empty item (a 0-sized matrix) counts as one operation
+    static int grain(long work) { return static_cast<int>(S21_PARALLEL_WORK / (work > 0 ? work : 1) + 1); }
+    // Cpu ids of every NUMA node under root (sysfs layout), indexed by node id.
+    // A box without NUMA information reports a single node with no cpu list.
+    static std::vector<std::vector<int>> numa_topology(const std::string& root = "/sys/devices/system/node");
+    // Nodes the workers are spread over; with more than one, worker i is pinned
+    // to the cpus of node i % numa_nodes().
+    int numa_nodes() const;
+    void submit(std::function<void()> task);
+    // Splits [begin, end) into contiguous chunks of at least grain items and runs
+    // body(chunk_begin, chunk_end) on the workers. The calling thread takes part,
+    // so nested calls from inside a worker cannot deadlock.
+    void parallel_for(int begin, int end, int grain, const std::function<void(int, int)>& body);
+};
+
+#endif  // SRC_S21_THREAD_POOL_H_